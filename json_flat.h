@@ -0,0 +1,116 @@
+#pragma once
+
+#include "json.h"
+
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace json {
+
+    class FlatDocument;
+
+    // Лёгкая ссылка на значение FlatDocument, действительна, пока существует документ
+    class FlatNode {
+    public:
+        bool IsInt() const;
+        bool Isdouble() const;
+        bool IsPuredouble() const;
+        bool IsNull() const;
+        bool IsString() const;
+        bool IsBool() const;
+        bool IsArray() const;
+        bool IsMap() const;
+
+        int AsInt() const;
+        double Asdouble() const;
+        std::string_view AsString() const;
+        bool AsBool() const;
+
+        // Число элементов массива или словаря
+        size_t Size() const;
+        // Элемент массива
+        FlatNode operator[](size_t index) const;
+        // Значение словаря по ключу: At бросает out_of_range, Find возвращает nullopt
+        FlatNode At(std::string_view key) const;
+        std::optional<FlatNode> Find(std::string_view key) const;
+        bool Contains(std::string_view key) const;
+
+    private:
+        friend class FlatDocument;
+
+        FlatNode(const FlatDocument* doc, uint32_t index) :doc_(doc), index_(index) {}
+        // Преобразует число, сохранённое ленивым документом в виде текста
+        Number GetNumber() const;
+
+        const FlatDocument* doc_;
+        uint32_t index_;
+    };
+
+    // Неизменяемый документ для чтения. Все значения лежат в одном массиве, элементы
+    // массива или словаря занимают в нём непрерывный участок, ключи словаря отсортированы.
+    // Строки без escape-последовательностей ссылаются на входной буфер, поэтому он должен
+    // существовать, пока используется документ. Память освобождается целиком вместе с документом.
+    // В ленивом режиме документ только размечает структуру: каждое значение по-прежнему
+    // получает ячейку, но числа и строки с escape-последовательностями хранятся текстом
+    // из входного буфера и преобразуются при обращении (строка - один раз, при первом AsString),
+    // а ключи словарей не сортируются и ищутся просмотром (повторяющиеся ключи при этом
+    // учитываются в Size). Первое обращение к такой строке изменяет документ, поэтому ленивый
+    // документ нельзя читать из нескольких потоков одновременно
+    class FlatDocument {
+    public:
+        explicit FlatDocument(std::string_view input, bool lazy = false);
+        // Документ, корень которого - массив из значений elements, лежащих внутри input
+        // (например, части результата SplitArray)
+        FlatDocument(std::string_view input, std::span<const std::string_view> elements, bool lazy = false);
+
+        FlatNode GetRoot() const;
+
+    private:
+        friend class FlatNode;
+        class Loader;
+
+        enum class Type : uint8_t {
+            NULL_VALUE,
+            BOOL,
+            INT,
+            DOUBLE,
+            // Текст числа, преобразуемый при обращении
+            NUMBER,
+            STRING,
+            // Текст строки с escape-последовательностями, декодируемый при первом обращении
+            ESCAPED_STRING,
+            ARRAY,
+            DICT
+        };
+
+        struct Value {
+            Type type = Type::NULL_VALUE;
+            // Длина строки или число элементов контейнера
+            uint32_t size = 0;
+            union {
+                bool boolean;
+                int integer;
+                double real;
+                const char* str;
+                // Индекс первого элемента контейнера
+                uint32_t first;
+            };
+        };
+
+        const Value& Get(uint32_t index) const;
+        // Декодирует строку ленивого документа и заменяет ею текст
+        std::string_view DecodeString(uint32_t index) const;
+
+        bool lazy_ = false;
+        mutable std::vector<Value> values_;
+        // Ключи элементов словарей, для остальных значений пустые
+        std::vector<std::string_view> keys_;
+        mutable std::deque<std::string> strings_;
+    };
+
+}  // namespace json
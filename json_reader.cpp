@@ -1,197 +1,560 @@
 #include "json_reader.h"
 #include "request_handler.h"
 #include "json_builder.h"
+#include "json_writer.h"
 #include "graph.h"
 #include "serialization.h"
+#include "snapshot.h"
+#include "parallel.h"
 
 #include <sstream>
 #include <optional>
 #include <cstdint>
 #include <utility>
 #include <vector>
+#include <limits>
+#include <deque>
+#include <span>
+#include <string_view>
+#include <functional>
+#include <map>
+#include <exception>
+#include <iterator>
+#include <algorithm>
+#include <tuple>
+#include <variant>
 
 using namespace std;
 
 namespace renderer {
-    void LoadJSON(catalogue::TransportCatalogue& transport_catalogue, istream& input) {
-        json::Document doc = json::Load(input);
+    namespace {
+        // Входные данные читаются целиком, чтобы разбирать их из непрерывного буфера
+        string ReadInput(istream& input) {
+            ostringstream buffer;
+            buffer << input.rdbuf();
+            return move(buffer).str();
+        }
 
-        BuildingCatalog(transport_catalogue, doc);
+        // Потоковая загрузка элементов base_requests: каждый элемент сразу переводится
+        // в описание остановки или автобуса, ссылающееся на входной буфер, без построения дерева
+        class BaseRequestsReader : public json::Handler {
+        public:
+            explicit BaseRequestsReader(string_view input) :input_(input) {}
+
+            void StartDict() override {
+                if (depth_ == 0) {
+                    is_stop_ = false;
+                    stop_ = {};
+                    bus_ = {};
+                }
+                ++depth_;
+            }
 
-        MapRenderer map;
-        map.SetRenderSettingsSVG(doc);
+            void EndDict() override {
+                if (--depth_ == 0)
+                    AddRequest();
+            }
 
-        Serialize(doc.GetRoot().AsMap().at("serialization_settings").AsMap().at("file").AsString(), transport_catalogue, map,
-            doc.GetRoot().AsMap().at("routing_settings").AsMap().at("bus_wait_time").Asdouble(),
-            doc.GetRoot().AsMap().at("routing_settings").AsMap().at("bus_velocity").Asdouble());
-    }
+            void StartArray() override {
+                CheckRequest();
+                ++depth_;
+            }
 
-    void ProcessRequests(catalogue::TransportCatalogue& transport_catalogue, istream& input) {
-        json::Document doc = json::Load(input);
-        MapRenderer map;
-        
-        auto value = Deserialize(doc.GetRoot().AsMap().at("serialization_settings").AsMap().at("file").AsString(),
-            transport_catalogue, map.GetSettingsSVG());
+            void EndArray() override {
+                --depth_;
+            }
 
-        router::TransportRouter transport_router(value.first, value.second);
-        graph::DirectedWeightedGraph<double> weighted_graph(transport_catalogue.GetStops().size());
+            void Key(string_view key) override {
+                if (depth_ == 1)
+                    field_ = GetField(key);
+                else if (depth_ == 2)
+                    distance_stop_ = Keep(key);
+            }
 
-        const double bus_wait_time = transport_router.GetBusWaitTime();
-        const double bus_velocity = transport_router.GetBusVelocity();
+            void String(string_view value) override {
+                CheckRequest();
+                if (depth_ == 1 && field_ == Field::TYPE)
+                    is_stop_ = !value.empty() && value[0] == 'S';
+                else if (depth_ == 1 && field_ == Field::NAME)
+                    stop_.name = bus_.name = Keep(value);
+                else if (depth_ == 2 && field_ == Field::STOPS)
+                    bus_.stops.push_back(Keep(value));
+            }
 
-        for (auto& bus : transport_catalogue.GetBuses()) {
-            for (size_t i = 0; i < bus.route.size(); ++i) {
-                double weight = bus_wait_time;
+            void Int(int value) override {
+                SetNumber(value);
+            }
 
-                for (size_t u = i + 1; u < bus.route.size(); ++u) {
-                    weight += transport_catalogue.GetDistanceBetweenStops(bus.route[u - 1], bus.route[u]) /
-                        1000 / bus_velocity * 60.0;
+            void Double(double value) override {
+                SetNumber(value);
+            }
 
-                    transport_router.SetEdgeId(weighted_graph.AddEdge(transport_router.AddEdge(bus.route[i], bus.route[u], weight)),
-                        bus.number_bus, bus.route[i], u - i, move(weight));
-                }
+            void Bool(bool value) override {
+                CheckRequest();
+                if (depth_ == 1 && field_ == Field::IS_ROUNDTRIP)
+                    bus_.is_roundtrip = value;
             }
-        }
 
-        graph::Router<double> router(weighted_graph);
+            void Null() override {
+                CheckRequest();
+            }
 
-        PrintAnswer(transport_catalogue, doc, map, transport_router, router);
-    }
+            vector<catalogue::StopDescription>& GetStops() {
+                return stops_;
+            }
 
-    void BuildingCatalog(catalogue::TransportCatalogue& transport_catalogue, json::Document& doc) {
-        for (const auto& node_map : doc.GetRoot().AsMap().at("base_requests").AsArray()) {
-            if (node_map.AsMap().at("type").AsString()[0] == 'S') {
-                string str = node_map.AsMap().at("name").AsString() + ": " + to_string(node_map.AsMap().at("latitude").Asdouble()) + ", " +
-                    to_string(node_map.AsMap().at("longitude").Asdouble());
+            vector<catalogue::BusDescription>& GetBuses() {
+                return buses_;
+            }
 
-                for (const auto& [key, val] : node_map.AsMap().at("road_distances").AsMap())
-                    str += "~ " + to_string(val.AsInt()) + "m " + key;
+        private:
+            enum class Field {
+                OTHER,
+                TYPE,
+                NAME,
+                LATITUDE,
+                LONGITUDE,
+                ROAD_DISTANCES,
+                STOPS,
+                IS_ROUNDTRIP
+            };
+
+            static Field GetField(string_view key) {
+                if (key == "type"sv)
+                    return Field::TYPE;
+                if (key == "name"sv)
+                    return Field::NAME;
+                if (key == "latitude"sv)
+                    return Field::LATITUDE;
+                if (key == "longitude"sv)
+                    return Field::LONGITUDE;
+                if (key == "road_distances"sv)
+                    return Field::ROAD_DISTANCES;
+                if (key == "stops"sv)
+                    return Field::STOPS;
+                if (key == "is_roundtrip"sv)
+                    return Field::IS_ROUNDTRIP;
+                return Field::OTHER;
+            }
 
-                transport_catalogue.AddStop(str, node_map.AsMap().at("latitude").Asdouble(), node_map.AsMap().at("longitude").Asdouble());
+            // Строки из входного буфера используются как есть, декодированные копируются
+            string_view Keep(string_view value) {
+                const less<const char*> before;
+                if (!before(value.data(), input_.data()) && before(value.data(), input_.data() + input_.size()))
+                    return value;
+                return escaped_.emplace_back(value);
             }
-            else {
-                string str = node_map.AsMap().at("name").AsString() + ": ";
-                const char separator = node_map.AsMap().at("is_roundtrip").AsBool() ? '>' : '`';
-                auto it = node_map.AsMap().at("stops").AsArray().begin();
-                const size_t size = node_map.AsMap().at("stops").AsArray().size();
 
-                for (size_t i = 0; i + 1 < size; ++i, ++it)
-                    str += (*it).AsString() + ' ' + separator + ' ';
-                str += (*prev(node_map.AsMap().at("stops").AsArray().end())).AsString();
+            void SetNumber(double value) {
+                CheckRequest();
+                if (depth_ == 1 && field_ == Field::LATITUDE)
+                    stop_.coords.lat = value;
+                else if (depth_ == 1 && field_ == Field::LONGITUDE)
+                    stop_.coords.lng = value;
+                else if (depth_ == 2 && field_ == Field::ROAD_DISTANCES)
+                    stop_.distances.emplace_back(distance_stop_, value);
+            }
 
-                transport_catalogue.ParseBus(str);
+            // Элемент base_requests должен быть словарём
+            void CheckRequest()const {
+                if (depth_ == 0)
+                    throw json::ParsingError("base_requests must be an array of requests");
             }
-        }
-    }
 
-    void PrintAnswer(catalogue::TransportCatalogue& transport_catalogue, json::Document& doc,
-        MapRenderer& map, router::TransportRouter& transport_router, graph::Router<double>& router) {
-        json::Array arr;
-        ::RequestHandler requests(transport_catalogue);
-
-        for (const auto& node_map : doc.GetRoot().AsMap().at("stat_requests").AsArray()) {
-            bool flag = false;
-
-            if (node_map.AsMap().at("type").AsString() == "Bus") {
-                if (const optional<BusStat> bus_stat = requests.GetBusStat(node_map.AsMap().at("name").AsString())) {
-                    arr.push_back(json::Builder{}.StartDict()
-                        .Key("stop_count").Value(bus_stat->stop_count)
-                        .Key("unique_stop_count").Value(bus_stat->unique_stop_count)
-                        .Key("route_length").Value(bus_stat->route_length)
-                        .Key("curvature").Value(bus_stat->curvature)
-                        .Key("request_id").Value(node_map.AsMap().at("id").AsInt())
-                        .EndDict().Build()
-                    );
-                }
+            void AddRequest() {
+                if (is_stop_)
+                    stops_.push_back(move(stop_));
                 else
-                    flag = true;
+                    buses_.push_back(move(bus_));
             }
-            else if (node_map.AsMap().at("type").AsString() == "Stop") {
-                if (const optional<set<string_view>> stop_stat = requests.GetBusesByStop(node_map.AsMap().at("name").AsString())) {
-                    json::Array arr_buses;
 
-                    for (auto& bus : stop_stat.value())
-                        arr_buses.push_back(json::Node(string(bus)));
+            string_view input_;
+            size_t depth_ = 0;
+            Field field_ = Field::OTHER;
+            bool is_stop_ = false;
+            string_view distance_stop_;
+            catalogue::StopDescription stop_;
+            catalogue::BusDescription bus_;
+
+            vector<catalogue::StopDescription>stops_;
+            vector<catalogue::BusDescription>buses_;
+            deque<string>escaped_;
+        };
+
+        // Разбирает [0, size) частями в нескольких потоках. Части следуют в порядке элементов,
+        // поэтому результат, собранный по номерам частей, не зависит от числа потоков.
+        // Первое по порядку частей исключение передаётся вызывающей стороне
+        template <typename ParsePart>
+        void ParseInParts(size_t size, size_t thread_count, ParsePart parse_part) {
+            vector<exception_ptr>errors(thread_count);
+            parallel::ForEachChunk(size, thread_count, [&](size_t begin, size_t end, size_t part) {
+                try {
+                    parse_part(begin, end, part);
+                }
+                catch (...) {
+                    errors[part] = current_exception();
+                }
+                });
+
+            for (const auto& error : errors)
+                if (error)
+                    rethrow_exception(error);
+        }
+
+        // Значения разделов верхнего уровня; из повторяющихся ключей берётся первый
+        map<string_view, string_view> SplitSections(string_view input) {
+            map<string_view, string_view>sections;
+            for (const auto& [key, value] : json::SplitDict(input))
+                sections.try_emplace(key, value);
+            return sections;
+        }
+
+        string_view GetSection(const map<string_view, string_view>& sections, string_view key) {
+            const auto it = sections.find(key);
+            if (it == sections.end())
+                throw out_of_range("Section "s + string(key) + " is not found"s);
+            return it->second;
+        }
 
-                    arr.push_back(json::Builder{}.StartDict()
-                        .Key("request_id").Value(node_map.AsMap().at("id").AsInt())
-                        .Key("buses").Value(arr_buses)
-                        .EndDict().Build()
-                    );
+        // Ответы на запросы с фиксированной структурой записываются в вывод без построения json::Node.
+        // Поля перечислены в алфавитном порядке, как их выводит json::Print
+        struct BusResponse {
+            double curvature;
+            int request_id;
+            int route_length;
+            int stop_count;
+            int unique_stop_count;
+
+            static constexpr auto FIELDS = make_tuple(
+                json::MakeField("curvature"sv, &BusResponse::curvature),
+                json::MakeField("request_id"sv, &BusResponse::request_id),
+                json::MakeField("route_length"sv, &BusResponse::route_length),
+                json::MakeField("stop_count"sv, &BusResponse::stop_count),
+                json::MakeField("unique_stop_count"sv, &BusResponse::unique_stop_count));
+        };
+
+        struct BusesResponse {
+            vector<string_view> buses;
+            int request_id;
+
+            static constexpr auto FIELDS = make_tuple(
+                json::MakeField("buses"sv, &BusesResponse::buses),
+                json::MakeField("request_id"sv, &BusesResponse::request_id));
+        };
+
+        struct NearestStop {
+            double distance;
+            string_view name;
+
+            static constexpr auto FIELDS = make_tuple(
+                json::MakeField("distance"sv, &NearestStop::distance),
+                json::MakeField("name"sv, &NearestStop::name));
+        };
+
+        struct NearestStopsResponse {
+            int request_id;
+            vector<NearestStop> stops = {};
+
+            static constexpr auto FIELDS = make_tuple(
+                json::MakeField("request_id"sv, &NearestStopsResponse::request_id),
+                json::MakeField("stops"sv, &NearestStopsResponse::stops));
+        };
+
+        struct SuggestResponse {
+            vector<string_view> buses;
+            int request_id;
+            vector<string_view> stops = {};
+
+            static constexpr auto FIELDS = make_tuple(
+                json::MakeField("buses"sv, &SuggestResponse::buses),
+                json::MakeField("request_id"sv, &SuggestResponse::request_id),
+                json::MakeField("stops"sv, &SuggestResponse::stops));
+        };
+
+        struct WaitItem {
+            string_view stop_name;
+            double time;
+            string_view type = "Wait"sv;
+
+            static constexpr auto FIELDS = make_tuple(
+                json::MakeField("stop_name"sv, &WaitItem::stop_name),
+                json::MakeField("time"sv, &WaitItem::time),
+                json::MakeField("type"sv, &WaitItem::type));
+        };
+
+        struct BusItem {
+            string_view bus;
+            double span_count;
+            double time;
+            string_view type = "Bus"sv;
+
+            static constexpr auto FIELDS = make_tuple(
+                json::MakeField("bus"sv, &BusItem::bus),
+                json::MakeField("span_count"sv, &BusItem::span_count),
+                json::MakeField("time"sv, &BusItem::time),
+                json::MakeField("type"sv, &BusItem::type));
+        };
+
+        struct RouteResponse {
+            vector<variant<WaitItem, BusItem>> items;
+            int request_id;
+            double total_time;
+
+            static constexpr auto FIELDS = make_tuple(
+                json::MakeField("items"sv, &RouteResponse::items),
+                json::MakeField("request_id"sv, &RouteResponse::request_id),
+                json::MakeField("total_time"sv, &RouteResponse::total_time));
+        };
+
+        struct MapResponse {
+            // Готовая карта снимка, при выводе не копируется и не обрабатывается повторно
+            reference_wrapper<const json::RawJson> map;
+            int request_id;
+
+            static constexpr auto FIELDS = make_tuple(
+                json::MakeField("map"sv, &MapResponse::map),
+                json::MakeField("request_id"sv, &MapResponse::request_id));
+        };
+
+        struct ErrorResponse {
+            string_view error_message;
+            int request_id;
+
+            static constexpr auto FIELDS = make_tuple(
+                json::MakeField("error_message"sv, &ErrorResponse::error_message),
+                json::MakeField("request_id"sv, &ErrorResponse::request_id));
+        };
+
+        // Запрос после разбора: тип определён один раз, названия заменены на id
+        enum class RequestKind : uint8_t {
+            BUS, STOP, DIRECT_BUSES, NEAREST_STOPS, SUGGEST, ROUTE, MAP, NOT_FOUND
+        };
+
+        struct CompiledRequest {
+            RequestKind kind;
+            int id;
+            // Id автобуса (BUS), остановок (STOP, DIRECT_BUSES) или вершин графа (ROUTE)
+            uint32_t from = 0;
+            uint32_t to = 0;
+            size_t count = 0;
+            double radius = 0;
+            geo::Coordinates center = {};
+            // Ссылается на документ запросов
+            string_view prefix = {};
+        };
+
+        CompiledRequest CompileRequest(const snapshot::CatalogueSnapshot& snapshot, const json::FlatNode& request) {
+            const auto& transport_catalogue = snapshot.transport_catalogue;
+            const auto& transport_router = *snapshot.transport_router;
+            const string_view type = request.At("type"sv).AsString();
+            CompiledRequest result{ RequestKind::NOT_FOUND, request.At("id"sv).AsInt() };
+
+            if (type == "Bus"sv) {
+                if (const catalogue::Bus* bus = transport_catalogue.FindBus(request.At("name"sv).AsString())) {
+                    result.kind = RequestKind::BUS;
+                    result.from = bus->id;
                 }
-                else
-                    flag = true;
             }
-            else if (node_map.AsMap().at("type").AsString() == "Route") {
-                const size_t from = transport_router.GetIdStops(node_map.AsMap().at("from").AsString());
-                const size_t to = transport_router.GetIdStops(node_map.AsMap().at("to").AsString());
+            else if (type == "Stop"sv) {
+                if (const catalogue::Stop* stop = transport_catalogue.FindStop(request.At("name"sv).AsString())) {
+                    result.kind = RequestKind::STOP;
+                    result.from = stop->id;
+                }
+            }
+            else if (type == "DirectBuses"sv) {
+                const catalogue::Stop* from = transport_catalogue.FindStop(request.At("from"sv).AsString());
+                const catalogue::Stop* to = transport_catalogue.FindStop(request.At("to"sv).AsString());
+                if (from && to) {
+                    result.kind = RequestKind::DIRECT_BUSES;
+                    result.from = from->id;
+                    result.to = to->id;
+                }
+            }
+            else if (type == "NearestStops"sv) {
+                result.kind = RequestKind::NEAREST_STOPS;
+                result.count = request.Contains("count"sv) ? request.At("count"sv).AsInt() : (request.Contains("radius"sv) ? 0 : 1);
+                result.radius = request.Contains("radius"sv) ? request.At("radius"sv).Asdouble() : numeric_limits<double>::infinity();
+                result.center = { request.At("latitude"sv).Asdouble(), request.At("longitude"sv).Asdouble() };
+            }
+            else if (type == "Suggest"sv) {
+                result.kind = RequestKind::SUGGEST;
+                result.prefix = request.At("prefix"sv).AsString();
+                result.count = request.Contains("count"sv) ? request.At("count"sv).AsInt() : 10;
+            }
+            else if (type == "Route"sv) {
+                // Неизвестная остановка получает id, равный числу остановок
+                const size_t from = transport_router.GetIdStops(request.At("from"sv).AsString());
+                const size_t to = transport_router.GetIdStops(request.At("to"sv).AsString());
+                if (from != transport_router.GetSizeIdStops() && to != transport_router.GetSizeIdStops()) {
+                    result.kind = RequestKind::ROUTE;
+                    result.from = static_cast<uint32_t>(from);
+                    result.to = static_cast<uint32_t>(to);
+                }
+            }
+            else
+                result.kind = RequestKind::MAP;
+
+            return result;
+        }
+
+        // Запросы всех частей в исходном порядке
+        vector<CompiledRequest> CompileRequests(const snapshot::CatalogueSnapshot& snapshot, span<const json::FlatDocument> requests_parts) {
+            vector<CompiledRequest>requests;
+            for (const json::FlatDocument& part : requests_parts) {
+                const json::FlatNode root = part.GetRoot();
+                requests.reserve(requests.size() + root.Size());
+                for (size_t index = 0; index < root.Size(); ++index)
+                    requests.push_back(CompileRequest(snapshot, root[index]));
+            }
+            return requests;
+        }
+    }
+
+    void LoadJSON(catalogue::TransportCatalogue& transport_catalogue, istream& input) {
+        const string buffer = ReadInput(input);
+        json::Document doc = BuildingCatalog(transport_catalogue, buffer);
+        transport_catalogue.Freeze();
+        transport_catalogue.BuildNameIndex();
+        transport_catalogue.BuildIndex();
+        transport_catalogue.ComputeBusStats();
+        transport_catalogue.BuildSpatialIndex();
+
+        MapRenderer map;
+        map.SetRenderSettingsSVG(doc);
+
+        Serialize(doc.GetRoot().AsMap().at("serialization_settings").AsMap().at("file").AsString(), transport_catalogue, map,
+            doc.GetRoot().AsMap().at("routing_settings").AsMap().at("bus_wait_time").Asdouble(),
+            doc.GetRoot().AsMap().at("routing_settings").AsMap().at("bus_velocity").Asdouble());
+    }
 
-                const auto route = router.BuildRoute(from, to);
+    void ProcessRequests(istream& input) {
+        const string buffer = ReadInput(input);
+        const auto sections = SplitSections(buffer);
+        const json::FlatDocument settings(GetSection(sections, "serialization_settings"sv));
 
-                if (route && from != transport_router.GetSizeIdStops()) {
-                    struct Item{
-                        bool wait;
-                        string_view name;
-                        double span_count;
-                        double time;
-                    };
+        snapshot::SnapshotHolder holder;
+        holder.Reload(string(settings.GetRoot().At("file").AsString()));
 
+        // Запросы разбираются частями в нескольких потоках, каждая часть - отдельный документ.
+        // Из запросов читаются лишь отдельные поля, поэтому документы разбираются лениво
+        const vector<string_view>requests = json::SplitArray(GetSection(sections, "stat_requests"sv));
+        const size_t thread_count = parallel::DefaultThreadCount();
+        vector<optional<json::FlatDocument>>parts(thread_count);
+
+        ParseInParts(requests.size(), thread_count, [&](size_t begin, size_t end, size_t part) {
+            parts[part].emplace(buffer, span(requests).subspan(begin, end - begin), true);
+            });
+
+        vector<json::FlatDocument>documents;
+        for (auto& part : parts)
+            if (part)
+                documents.push_back(move(*part));
+
+        PrintAnswer(*holder.Pin(), documents);
+    }
+
+    json::Document BuildingCatalog(catalogue::TransportCatalogue& transport_catalogue, string_view input) {
+        json::Dict settings;
+        vector<string_view>requests;
+        for (const auto& [key, value] : SplitSections(input)) {
+            if (key == "base_requests"sv)
+                requests = json::SplitArray(value);
+            else
+                settings.emplace(string(key), json::Load(value).GetRoot());
+        }
+
+        // Элементы разбираются частями в нескольких потоках и склеиваются в порядке частей
+        const size_t thread_count = parallel::DefaultThreadCount();
+        vector<BaseRequestsReader>readers(thread_count, BaseRequestsReader(input));
+        ParseInParts(requests.size(), thread_count, [&](size_t begin, size_t end, size_t part) {
+            for (size_t i = begin; i < end; ++i)
+                json::Parse(requests[i], readers[part]);
+            });
+
+        vector<catalogue::StopDescription>stops;
+        vector<catalogue::BusDescription>buses;
+        for (auto& reader : readers) {
+            move(reader.GetStops().begin(), reader.GetStops().end(), back_inserter(stops));
+            move(reader.GetBuses().begin(), reader.GetBuses().end(), back_inserter(buses));
+        }
+        transport_catalogue.AddStopsAndBuses(stops, buses);
+
+        return json::Document(json::Node(move(settings)));
+    }
+
+    void PrintAnswer(const snapshot::CatalogueSnapshot& snapshot, span<const json::FlatDocument> requests_parts) {
+        const auto& transport_catalogue = snapshot.transport_catalogue;
+        const auto& transport_router = *snapshot.transport_router;
+        const auto& router = *snapshot.router;
+        json::ArrayWriter writer(cout);
+        const ::RequestHandler handler(transport_catalogue);
+
+        const auto bus_names = [&](auto buses) {
+            vector<string_view>names;
+            names.reserve(buses.size());
+            for (const catalogue::BusId bus : buses)
+                names.push_back(transport_catalogue.GetBuses()[bus].number_bus);
+            return names;
+        };
+
+        for (const CompiledRequest& request : CompileRequests(snapshot, requests_parts)) {
+            const int request_id = request.id;
+
+            switch (request.kind) {
+            case RequestKind::BUS: {
+                const BusStat& bus_stat = handler.GetBusStat(request.from);
+                writer.Add(BusResponse{ bus_stat.curvature, request_id, bus_stat.route_length,
+                    bus_stat.stop_count, bus_stat.unique_stop_count });
+                break;
+            }
+            case RequestKind::STOP:
+                writer.Add(BusesResponse{ bus_names(handler.GetBusesByStop(request.from)), request_id });
+                break;
+            case RequestKind::DIRECT_BUSES:
+                writer.Add(BusesResponse{ bus_names(handler.GetDirectBuses(request.from, request.to)), request_id });
+                break;
+            case RequestKind::NEAREST_STOPS: {
+                NearestStopsResponse response{ request_id };
+                for (const auto& [stop, distance] : handler.GetNearestStops(request.center, request.count, request.radius))
+                    response.stops.push_back({ distance, transport_catalogue.GetStops()[stop].name_stop });
+
+                writer.Add(response);
+                break;
+            }
+            case RequestKind::SUGGEST: {
+                SuggestResponse response{ bus_names(transport_catalogue.SuggestBuses(request.prefix, request.count)), request_id };
+                for (const catalogue::StopId stop : transport_catalogue.SuggestStops(request.prefix, request.count))
+                    response.stops.push_back(transport_catalogue.GetStops()[stop].name_stop);
+
+                writer.Add(response);
+                break;
+            }
+            case RequestKind::ROUTE:
+                if (const auto route = router.BuildRoute(request.from, request.to)) {
                     const double wait_time = transport_router.GetBusWaitTime();
-                    vector<Item>arr_items;
+                    RouteResponse response{ {}, request_id, (*route).weight };
+                    response.items.reserve((*route).edges.size() * 2);
 
                     for (size_t i = 0; i < (*route).edges.size(); ++i) {
                         const auto& edge = transport_router.GetInfoEdge((*route).edges[i]);
 
-                        arr_items.push_back({ true,edge.stop ,0,wait_time });
-                        arr_items.push_back({ false,edge.bus, edge.span_count ,edge.weight - wait_time });
+                        response.items.push_back(WaitItem{ edge.stop, wait_time });
+                        response.items.push_back(BusItem{ edge.bus, edge.span_count, edge.weight - wait_time });
                     }
 
-                    auto builder = json::Builder{};
-                    auto json_obj = builder.StartDict()
-                        .Key("request_id").Value(node_map.AsMap().at("id").AsInt())
-                        .Key("total_time").Value((*route).weight)
-                        .Key("items").StartArray();
-
-                    for (auto [wait, name, cnt_stops, time_edge] : arr_items) {
-                        if (wait) {
-                            json_obj.StartDict()
-                                .Key("type").Value("Wait"s)
-                                .Key("stop_name").Value(string(name))
-                                .Key("time").Value(time_edge)
-                                .EndDict();
-                        }
-                        else {
-                            json_obj.StartDict()
-                                .Key("type").Value("Bus"s)
-                                .Key("bus").Value(string(name))
-                                .Key("span_count").Value(cnt_stops)
-                                .Key("time").Value(time_edge)
-                                .EndDict();
-                        }
-                    }
-
-                    arr.push_back(json_obj.EndArray().EndDict().Build());
+                    writer.Add(response);
                 }
                 else
-                    flag = true;
-            }
-            else {
-                arr.push_back(json::Builder{}.StartDict()
-                    .Key("map").Value(map.BuildingMap(transport_catalogue))
-                    .Key("request_id").Value(node_map.AsMap().at("id").AsInt())
-                    .EndDict().Build()
-                );
-            }
-
-            if (flag) {
-                arr.push_back(json::Builder{}.StartDict()
-                    .Key("request_id").Value(node_map.AsMap().at("id").AsInt())
-                    .Key("error_message").Value("not found"s)
-                    .EndDict().Build()
-                );
+                    writer.Add(ErrorResponse{ "not found"sv, request_id });
+                break;
+            case RequestKind::MAP:
+                writer.Add(MapResponse{ cref(snapshot.rendered_map), request_id });
+                break;
+            default:
+                writer.Add(ErrorResponse{ "not found"sv, request_id });
             }
         }
 
-        json::Print(json::Document(arr), cout);
+        writer.Finish();
     }
-}
\ No newline at end of file
+}
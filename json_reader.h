@@ -2,16 +2,21 @@
 
 #include "transport_catalogue.h"
 #include "json.h"
+#include "json_flat.h"
 #include "map_renderer.h"
 #include "transport_router.h"
 #include "router.h"
+#include "snapshot.h"
 
 #include <iostream>
+#include <string_view>
+#include <span>
 
 namespace renderer {
 	void LoadJSON(catalogue::TransportCatalogue& transport_catalogue, std::istream& input);
-	void ProcessRequests(catalogue::TransportCatalogue& transport_catalogue, std::istream& input);
-	void BuildingCatalog(catalogue::TransportCatalogue& transport_catalogue, json::Document& doc);
-	void PrintAnswer(catalogue::TransportCatalogue& transport_catalogue, json::Document& doc,
-		MapRenderer& map, router::TransportRouter& transport_router, graph::Router<double>& router);
+	void ProcessRequests(std::istream& input);
+	// Загружает base_requests без построения дерева и возвращает остальные разделы документа
+	json::Document BuildingCatalog(catalogue::TransportCatalogue& transport_catalogue, std::string_view input);
+	// Запросы - части stat_requests по порядку, корень каждой части - массив запросов
+	void PrintAnswer(const snapshot::CatalogueSnapshot& snapshot, std::span<const json::FlatDocument> requests_parts);
 }
\ No newline at end of file
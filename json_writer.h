@@ -0,0 +1,129 @@
+#pragma once
+
+#include "json.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+namespace json {
+
+    // Поле структуры ответа: имя ключа и указатель на член
+    template <typename Owner, typename Type>
+    struct Field {
+        std::string_view name;
+        Type Owner::* member;
+    };
+
+    template <typename Owner, typename Type>
+    constexpr Field<Owner, Type> MakeField(std::string_view name, Type Owner::* member) {
+        return { name, member };
+    }
+
+    // Структура записывается как словарь, если перечисляет свои поля в static constexpr FIELDS
+    template <typename Value>
+    concept Described = requires { std::tuple_size<decltype(Value::FIELDS)>::value; };
+
+    // Запись значений сразу в выходной буфер в том же формате, что и Print
+    void PrintValue(int value, std::string& out);
+    void PrintValue(double value, std::string& out);
+    void PrintValue(bool value, std::string& out);
+    void PrintValue(std::string_view value, std::string& out);
+    void PrintValue(const RawJson& value, std::string& out);
+    void PrintValue(const Node& node, std::string& out);
+
+    inline void PrintValue(const std::string& value, std::string& out) {
+        PrintValue(std::string_view(value), out);
+    }
+
+    // Значение, которое хранится вне структуры ответа
+    template <typename Value>
+    void PrintValue(std::reference_wrapper<Value> value, std::string& out) {
+        PrintValue(value.get(), out);
+    }
+
+    template <typename Value>
+    void PrintValue(const std::vector<Value>& values, std::string& out);
+    template <typename... Values>
+    void PrintValue(const std::variant<Values...>& value, std::string& out);
+    template <Described Value>
+    void PrintValue(const Value& value, std::string& out);
+
+    template <typename Value>
+    void PrintValue(const std::vector<Value>& values, std::string& out) {
+        out += "[\n";
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i)
+                out += ",\n";
+            PrintValue(values[i], out);
+        }
+        out += "\n]";
+    }
+
+    template <typename... Values>
+    void PrintValue(const std::variant<Values...>& value, std::string& out) {
+        std::visit([&out](const auto& alternative) {
+            PrintValue(alternative, out);
+            }, value);
+    }
+
+    // Print выводит ключи словаря по возрастанию, поэтому поля должны быть перечислены так же
+    template <typename Fields>
+    constexpr bool AreFieldsSorted(const Fields& fields) {
+        return std::apply([](const auto&... field) {
+            const std::array<std::string_view, sizeof...(field)> names = { field.name... };
+            return std::is_sorted(names.begin(), names.end());
+            }, fields);
+    }
+
+    template <Described Value>
+    void PrintValue(const Value& value, std::string& out) {
+        static_assert(AreFieldsSorted(Value::FIELDS), "FIELDS must be sorted by name");
+
+        out += "{\n";
+        bool first = true;
+        std::apply([&](const auto&... field) {
+            ((out += first ? "\"" : ",\n\"", first = false, out += field.name, out += "\": ",
+                PrintValue(value.*field.member, out)), ...);
+            }, Value::FIELDS);
+        out += "\n}";
+    }
+
+    // Потоковый вывод массива: каждый элемент печатается в буфер сразу после добавления,
+    // а буфер сбрасывается в поток крупными блоками. Формат совпадает с Print
+    class ArrayWriter {
+    public:
+        explicit ArrayWriter(std::ostream& output, size_t buffer_size = 1 << 16);
+
+        // Элемент - узел json::Node или типизированное значение, которое пишется без построения дерева
+        template <typename Value>
+        void Add(const Value& value);
+        // Закрывает массив и записывает остаток буфера
+        void Finish();
+
+    private:
+        void Flush();
+
+        std::ostream& output_;
+        size_t buffer_size_;
+        std::string buffer_;
+        bool is_empty_ = true;
+    };
+
+    template <typename Value>
+    void ArrayWriter::Add(const Value& value) {
+        buffer_ += is_empty_ ? "[\n" : ",\n";
+        is_empty_ = false;
+        PrintValue(value, buffer_);
+        if (buffer_.size() >= buffer_size_)
+            Flush();
+    }
+
+}  // namespace json
@@ -18,14 +18,14 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    catalogue::TransportCatalogue transport_catalogue;
     const std::string_view mode(argv[1]);
 
     if (mode == "make_base"sv) {
+        catalogue::TransportCatalogue transport_catalogue;
         renderer::LoadJSON(transport_catalogue, cin);
     }
     else if (mode == "process_requests"sv) {
-        renderer::ProcessRequests(transport_catalogue, cin);
+        renderer::ProcessRequests(cin);
     }
     else {
         PrintUsage();
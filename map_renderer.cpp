@@ -54,22 +54,25 @@ namespace renderer {
         }
     }
 
-    string MapRenderer::BuildingMap(catalogue::TransportCatalogue& transport_catalogue) {
-        vector<catalogue::Stop*>stops;
+    json::RawJson MapRenderer::BuildingMap(const catalogue::TransportCatalogue& transport_catalogue) {
+        // Каждая отрисовка начинается с пустого документа
+        doc_svg_ = svg::Document();
+
+        vector<const catalogue::Stop*>stops;
         stops.reserve(transport_catalogue.GetStops().size());
         for (auto &stop : transport_catalogue.GetStops())
-            if (!transport_catalogue.FindStop(stop.name_stop)->empty())
+            if (!transport_catalogue.GetBusesForStop(stop.id).empty())
                 stops.push_back(&stop);
         sort(stops.begin(), stops.end(), [](const catalogue::Stop* lhs, const catalogue::Stop* rhs) {
             return lhs->name_stop < rhs->name_stop;
             });
         
-        vector<catalogue::Bus*>buses;
+        vector<const catalogue::Bus*>buses;
         buses.reserve(transport_catalogue.GetBuses().size());
         for (auto& bus : transport_catalogue.GetBuses())
             if (!bus.route.empty())
                 buses.push_back(&bus);
-        sort(buses.begin(), buses.end(), [](catalogue::Bus* lhs, catalogue::Bus* rhs) {
+        sort(buses.begin(), buses.end(), [](const catalogue::Bus* lhs, const catalogue::Bus* rhs) {
             return (*lhs).number_bus < (*rhs).number_bus;
             });
 
@@ -78,25 +81,25 @@ namespace renderer {
         
         AddPolyline(transport_catalogue, sphere_projector, buses);
         AddRouteNames(transport_catalogue, sphere_projector, buses);
-        AddCircle(transport_catalogue, sphere_projector, stops);
-        AddNameStops(transport_catalogue, sphere_projector, stops);
+        AddCircle(sphere_projector, stops);
+        AddNameStops(sphere_projector, stops);
 
         ostringstream oss;
         doc_svg_.Render(oss);
 
-        return move(oss.str());
+        return json::MakeRawString(oss.view());
     }
 
-    void MapRenderer::AddPolyline(catalogue::TransportCatalogue& transport_catalogue, SphereProjector& sphere_projector, vector<catalogue::Bus*>&buses) {
+    void MapRenderer::AddPolyline(const catalogue::TransportCatalogue& transport_catalogue, SphereProjector& sphere_projector, vector<const catalogue::Bus*>&buses) {
         int j = 0;
         const int mod = settings_svg_.color_palette.size();
 
         for (const auto&bus : buses) {
             svg::Polyline polyline;
 
-            for (const auto& stop : bus->route) {
-                polyline.AddPoint(sphere_projector({ transport_catalogue.GetPointerStop().at(stop)->lat,
-                    transport_catalogue.GetPointerStop().at(stop)->lng }));
+            for (const auto stop_id : bus->GetFullRoute()) {
+                const auto& stop = transport_catalogue.GetStops()[stop_id];
+                polyline.AddPoint(sphere_projector({ stop.lat, stop.lng }));
             }
             doc_svg_.Add(polyline.SetStrokeColor(settings_svg_.color_palette[j % mod]).SetFillColor("none"s)
                 .SetStrokeWidth(settings_svg_.line_width).SetStrokeLineCap(svg::StrokeLineCap::ROUND).SetStrokeLineJoin(svg::StrokeLineJoin::ROUND));
@@ -104,7 +107,7 @@ namespace renderer {
         }
     }
 
-    void MapRenderer::AddRouteNames(catalogue::TransportCatalogue& transport_catalogue, SphereProjector& sphere_projector, vector<catalogue::Bus*>& buses) {
+    void MapRenderer::AddRouteNames(const catalogue::TransportCatalogue& transport_catalogue, SphereProjector& sphere_projector, vector<const catalogue::Bus*>& buses) {
         int j = -1;
         const int mod = settings_svg_.color_palette.size();
 
@@ -113,35 +116,35 @@ namespace renderer {
             svg::Text text;
             ++j;
 
-            text_background.SetPosition(sphere_projector({ transport_catalogue.GetPointerStop().at(bus->route[0])->lat,transport_catalogue.GetPointerStop().at(bus->route[0])->lng }))
+            text_background.SetPosition(sphere_projector({ transport_catalogue.GetStops()[bus->route[0]].lat,transport_catalogue.GetStops()[bus->route[0]].lng }))
                 .SetOffset({ settings_svg_.bus_label_offset.first,settings_svg_.bus_label_offset.second })
-                .SetFontSize(settings_svg_.bus_label_font_size).SetFontFamily("Verdana").SetFontWeight("bold").SetData(bus->number_bus)
+                .SetFontSize(settings_svg_.bus_label_font_size).SetFontFamily("Verdana").SetFontWeight("bold").SetData(string(bus->number_bus))
                 .SetFillColor(settings_svg_.underlayer_color).SetStrokeColor(settings_svg_.underlayer_color)
                 .SetStrokeWidth(settings_svg_.underlayer_width).SetStrokeLineCap(svg::StrokeLineCap::ROUND).SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
 
-            text.SetPosition(sphere_projector({ transport_catalogue.GetPointerStop().at(bus->route[0])->lat,transport_catalogue.GetPointerStop().at(bus->route[0])->lng }))
+            text.SetPosition(sphere_projector({ transport_catalogue.GetStops()[bus->route[0]].lat,transport_catalogue.GetStops()[bus->route[0]].lng }))
                 .SetOffset({ settings_svg_.bus_label_offset.first,settings_svg_.bus_label_offset.second })
-                .SetFontSize(settings_svg_.bus_label_font_size).SetFontFamily("Verdana").SetFontWeight("bold").SetData(bus->number_bus)
+                .SetFontSize(settings_svg_.bus_label_font_size).SetFontFamily("Verdana").SetFontWeight("bold").SetData(string(bus->number_bus))
                 .SetFillColor(settings_svg_.color_palette[j % mod]);
 
             doc_svg_.Add(text_background);
             doc_svg_.Add(text);
 
             if (bus->route.size() != 1 && !bus->is_roundtrip) {
-                const int finish = static_cast<int>(bus->route.size()) / 2;
+                const int finish = static_cast<int>(bus->route.size()) - 1;
 
                 if (bus->route[0] == bus->route[finish])
                     continue;
 
-                text_background.SetPosition(sphere_projector({ transport_catalogue.GetPointerStop().at(bus->route[finish])->lat,transport_catalogue.GetPointerStop().at(bus->route[finish])->lng }))
+                text_background.SetPosition(sphere_projector({ transport_catalogue.GetStops()[bus->route[finish]].lat,transport_catalogue.GetStops()[bus->route[finish]].lng }))
                     .SetOffset({ settings_svg_.bus_label_offset.first,settings_svg_.bus_label_offset.second })
-                    .SetFontSize(settings_svg_.bus_label_font_size).SetFontFamily("Verdana").SetFontWeight("bold").SetData(bus->number_bus)
+                    .SetFontSize(settings_svg_.bus_label_font_size).SetFontFamily("Verdana").SetFontWeight("bold").SetData(string(bus->number_bus))
                     .SetFillColor(settings_svg_.underlayer_color).SetStrokeColor(settings_svg_.underlayer_color)
                     .SetStrokeWidth(settings_svg_.underlayer_width).SetStrokeLineCap(svg::StrokeLineCap::ROUND).SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
 
-                text.SetPosition(sphere_projector({ transport_catalogue.GetPointerStop().at(bus->route[finish])->lat,transport_catalogue.GetPointerStop().at(bus->route[finish])->lng }))
+                text.SetPosition(sphere_projector({ transport_catalogue.GetStops()[bus->route[finish]].lat,transport_catalogue.GetStops()[bus->route[finish]].lng }))
                     .SetOffset({ settings_svg_.bus_label_offset.first,settings_svg_.bus_label_offset.second })
-                    .SetFontSize(settings_svg_.bus_label_font_size).SetFontFamily("Verdana").SetFontWeight("bold").SetData(bus->number_bus)
+                    .SetFontSize(settings_svg_.bus_label_font_size).SetFontFamily("Verdana").SetFontWeight("bold").SetData(string(bus->number_bus))
                     .SetFillColor(settings_svg_.color_palette[j % mod]);
 
                 doc_svg_.Add(text_background);
@@ -150,29 +153,29 @@ namespace renderer {
         }
     }
 
-    void MapRenderer::AddCircle(catalogue::TransportCatalogue& transport_catalogue, SphereProjector& sphere_projector, vector<catalogue::Stop*>&stops) {
+    void MapRenderer::AddCircle(SphereProjector& sphere_projector, vector<const catalogue::Stop*>&stops) {
         for (const auto&stop : stops) {
             svg::Circle circle;
-            circle.SetCenter(sphere_projector({ transport_catalogue.GetPointerStop().at(stop->name_stop)->lat, transport_catalogue.GetPointerStop().at(stop->name_stop)->lng }))
+            circle.SetCenter(sphere_projector({ stop->lat, stop->lng }))
                 .SetRadius(settings_svg_.stop_radius).SetFillColor("white");
             doc_svg_.Add(circle);
         }
     }
 
-    void MapRenderer::AddNameStops(catalogue::TransportCatalogue& transport_catalogue, SphereProjector& sphere_projector, vector<catalogue::Stop*>& stops) {
+    void MapRenderer::AddNameStops(SphereProjector& sphere_projector, vector<const catalogue::Stop*>& stops) {
         for (const auto&stop : stops) {
             svg::Text text_background;
             svg::Text text;
 
-            text_background.SetPosition(sphere_projector({ transport_catalogue.GetPointerStop().at(stop->name_stop)->lat,transport_catalogue.GetPointerStop().at(stop->name_stop)->lng }))
+            text_background.SetPosition(sphere_projector({ stop->lat,stop->lng }))
                 .SetOffset({ settings_svg_.stop_label_offset.first,settings_svg_.stop_label_offset.second })
-                .SetFontSize(settings_svg_.stop_label_font_size).SetFontFamily("Verdana").SetData(stop->name_stop)
+                .SetFontSize(settings_svg_.stop_label_font_size).SetFontFamily("Verdana").SetData(string(stop->name_stop))
                 .SetFillColor(settings_svg_.underlayer_color).SetStrokeColor(settings_svg_.underlayer_color)
                 .SetStrokeWidth(settings_svg_.underlayer_width).SetStrokeLineCap(svg::StrokeLineCap::ROUND).SetStrokeLineJoin(svg::StrokeLineJoin::ROUND);
 
-            text.SetPosition(sphere_projector({ transport_catalogue.GetPointerStop().at(stop->name_stop)->lat,transport_catalogue.GetPointerStop().at(stop->name_stop)->lng }))
+            text.SetPosition(sphere_projector({ stop->lat,stop->lng }))
                 .SetOffset({ settings_svg_.stop_label_offset.first,settings_svg_.stop_label_offset.second })
-                .SetFontSize(settings_svg_.stop_label_font_size).SetFontFamily("Verdana").SetData(stop->name_stop)
+                .SetFontSize(settings_svg_.stop_label_font_size).SetFontFamily("Verdana").SetData(string(stop->name_stop))
                 .SetFillColor("black");
 
             doc_svg_.Add(text_background);
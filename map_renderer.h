@@ -97,11 +97,12 @@ namespace renderer {
     class MapRenderer {
     public:
         void SetRenderSettingsSVG(json::Document& doc);
-        std::string BuildingMap(catalogue::TransportCatalogue& transport_catalogue);
-        void AddPolyline(catalogue::TransportCatalogue& transport_catalogue, SphereProjector& sphere_projector, std::vector<catalogue::Bus*>& buses);
-        void AddRouteNames(catalogue::TransportCatalogue& transport_catalogue, SphereProjector& sphere_projector, std::vector<catalogue::Bus*>& buses);
-        void AddCircle(catalogue::TransportCatalogue& transport_catalogue, SphereProjector& sphere_projector, std::vector<catalogue::Stop*>&stops);
-        void AddNameStops(catalogue::TransportCatalogue& transport_catalogue, SphereProjector& sphere_projector, std::vector<catalogue::Stop*>& stops);
+        // SVG карты сразу в виде экранированного строкового литерала JSON
+        json::RawJson BuildingMap(const catalogue::TransportCatalogue& transport_catalogue);
+        void AddPolyline(const catalogue::TransportCatalogue& transport_catalogue, SphereProjector& sphere_projector, std::vector<const catalogue::Bus*>& buses);
+        void AddRouteNames(const catalogue::TransportCatalogue& transport_catalogue, SphereProjector& sphere_projector, std::vector<const catalogue::Bus*>& buses);
+        void AddCircle(SphereProjector& sphere_projector, std::vector<const catalogue::Stop*>&stops);
+        void AddNameStops(SphereProjector& sphere_projector, std::vector<const catalogue::Stop*>& stops);
         RenderSettingsSVG& GetSettingsSVG();
 
     private:
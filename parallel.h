@@ -0,0 +1,33 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+    inline size_t DefaultThreadCount() {
+        return std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    // Делит диапазон [0, size) на thread_count непрерывных частей и обрабатывает каждую в своём потоке.
+    // func(begin, end, part) не должна выбрасывать исключений. Границы частей зависят только
+    // от size и thread_count, поэтому результаты, собранные по номерам частей, детерминированы.
+    template <typename Func>
+    void ForEachChunk(size_t size, size_t thread_count, Func func) {
+        thread_count = std::max<size_t>(1, std::min(thread_count, size));
+
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+        for (size_t part = 1; part < thread_count; ++part) {
+            threads.emplace_back(func, size * part / thread_count, size * (part + 1) / thread_count, part);
+        }
+        func(size_t{ 0 }, size / thread_count, size_t{ 0 });
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+}  // namespace parallel
@@ -0,0 +1,141 @@
+#include "perfect_hash.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+
+namespace catalogue {
+	namespace {
+		// Средний размер корзины
+		const size_t BUCKET_SIZE = 4;
+		const uint32_t MAX_PILOT = 1u << 24;
+
+		uint64_t Mix(uint64_t value) {
+			value ^= value >> 33;
+			value *= 0xff51afd7ed558ccdull;
+			value ^= value >> 33;
+			value *= 0xc4ceb9fe1a85ec53ull;
+			value ^= value >> 33;
+			return value;
+		}
+
+		// FNV-1a: результат не зависит от платформы и стандартной библиотеки,
+		// поэтому таблица из базы пригодна в любом процессе
+		uint64_t Hash(string_view key, uint64_t seed) {
+			uint64_t hash = 0xcbf29ce484222325ull ^ seed;
+			for (const char c : key) {
+				hash ^= static_cast<unsigned char>(c);
+				hash *= 0x100000001b3ull;
+			}
+			return Mix(hash);
+		}
+
+		size_t GetBucket(uint64_t hash, size_t bucket_count) {
+			return (hash >> 32) % bucket_count;
+		}
+
+		size_t GetSlot(uint64_t hash, uint32_t pilot, size_t slot_count) {
+			return Mix(hash ^ (pilot * 0x9e3779b97f4a7c15ull)) % slot_count;
+		}
+	}
+
+	void PerfectHash::Build(const vector<string_view>& keys) {
+		pilots_.clear();
+		ids_.clear();
+		if (keys.empty())
+			return;
+
+		// Для повторяющихся ключей смещения не подобрать ни при каком seed
+		vector<string_view>sorted_keys = keys;
+		sort(sorted_keys.begin(), sorted_keys.end());
+		if (adjacent_find(sorted_keys.begin(), sorted_keys.end()) != sorted_keys.end())
+			throw invalid_argument("Keys of the perfect hash must be unique");
+
+		const size_t slot_count = keys.size();
+		const size_t bucket_count = (keys.size() + BUCKET_SIZE - 1) / BUCKET_SIZE;
+		vector<uint64_t>hashes(keys.size());
+		vector<size_t>slots;
+
+		for (seed_ = 0;; ++seed_) {
+			for (size_t i = 0; i < keys.size(); ++i)
+				hashes[i] = Hash(keys[i], seed_);
+
+			// Ключи группируются по корзинам, корзины обрабатываются от больших к меньшим
+			vector<uint32_t>order(keys.size());
+			iota(order.begin(), order.end(), 0);
+			stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+				return GetBucket(hashes[lhs], bucket_count) < GetBucket(hashes[rhs], bucket_count);
+				});
+
+			vector<pair<uint32_t, uint32_t>>buckets;
+			for (size_t begin = 0, end = 0; begin < order.size(); begin = end) {
+				const size_t bucket = GetBucket(hashes[order[begin]], bucket_count);
+				for (end = begin; end < order.size() && GetBucket(hashes[order[end]], bucket_count) == bucket; ++end) {}
+				buckets.push_back({ static_cast<uint32_t>(begin), static_cast<uint32_t>(end) });
+			}
+			stable_sort(buckets.begin(), buckets.end(), [](const auto& lhs, const auto& rhs) {
+				return lhs.second - lhs.first > rhs.second - rhs.first;
+				});
+
+			pilots_.assign(bucket_count, 0);
+			ids_.assign(slot_count, NPOS);
+			bool success = true;
+
+			for (const auto& [begin, end] : buckets) {
+				uint32_t pilot = 0;
+				for (; pilot < MAX_PILOT; ++pilot) {
+					slots.clear();
+					for (uint32_t i = begin; i < end; ++i) {
+						const size_t slot = GetSlot(hashes[order[i]], pilot, slot_count);
+						if (ids_[slot] != NPOS || find(slots.begin(), slots.end(), slot) != slots.end())
+							break;
+						slots.push_back(slot);
+					}
+					if (slots.size() == end - begin)
+						break;
+				}
+
+				if (pilot == MAX_PILOT) {
+					success = false;
+					break;
+				}
+				pilots_[GetBucket(hashes[order[begin]], bucket_count)] = pilot;
+				for (uint32_t i = begin; i < end; ++i)
+					ids_[slots[i - begin]] = order[i];
+			}
+
+			if (success)
+				return;
+			if (seed_ > 64)
+				throw invalid_argument("Keys of the perfect hash must be unique");
+		}
+	}
+
+	void PerfectHash::Restore(uint64_t seed, vector<uint32_t> pilots, vector<uint32_t> ids) {
+		seed_ = seed;
+		pilots_ = move(pilots);
+		ids_ = move(ids);
+	}
+
+	uint32_t PerfectHash::Find(string_view key)const {
+		if (ids_.empty())
+			return NPOS;
+		const uint64_t hash = Hash(key, seed_);
+		return ids_[GetSlot(hash, pilots_[GetBucket(hash, pilots_.size())], ids_.size())];
+	}
+
+	uint64_t PerfectHash::GetSeed()const {
+		return seed_;
+	}
+
+	const vector<uint32_t>& PerfectHash::GetPilots()const {
+		return pilots_;
+	}
+
+	const vector<uint32_t>& PerfectHash::GetIds()const {
+		return ids_;
+	}
+}
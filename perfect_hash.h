@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+namespace catalogue {
+	// Минимальная совершенная хеш-функция для неизменяемого набора строк (схема hash-and-displace).
+	// Ключи раскладываются по корзинам, для каждой корзины подбирается смещение (pilot),
+	// при котором все её ключи попадают в свободные ячейки. Таблица хранит только смещения
+	// и id ключа в каждой ячейке, сами строки проверяет вызывающая сторона.
+	class PerfectHash {
+	public:
+		static constexpr uint32_t NPOS = std::numeric_limits<uint32_t>::max();
+
+		// keys[i] получает id i, ключи должны быть различны
+		void Build(const std::vector<std::string_view>& keys);
+		void Restore(uint64_t seed, std::vector<uint32_t> pilots, std::vector<uint32_t> ids);
+
+		// Единственный id, которому может соответствовать key, или NPOS для пустой таблицы
+		uint32_t Find(std::string_view key)const;
+
+		uint64_t GetSeed()const;
+		const std::vector<uint32_t>& GetPilots()const;
+		const std::vector<uint32_t>& GetIds()const;
+
+	private:
+		uint64_t seed_ = 0;
+		std::vector<uint32_t>pilots_;
+		std::vector<uint32_t>ids_;
+	};
+}
@@ -1,36 +1,24 @@
 #include "request_handler.h"
 #include "transport_catalogue.h"
-#include "geo.h"
 
 #include <iostream>
-#include <unordered_set>
 
 using namespace std;
 
-RequestHandler::RequestHandler(catalogue::TransportCatalogue& transport_catalogue) :link_catalog_(transport_catalogue) {}
+RequestHandler::RequestHandler(const catalogue::TransportCatalogue& transport_catalogue) :link_catalog_(transport_catalogue) {}
 
-optional<BusStat> RequestHandler::GetBusStat(const string_view& bus_name) const {
-	string name(bus_name.begin(), bus_name.end());
-	catalogue::Bus* it = link_catalog_.FindBus(name);
-	if (!it)
-		return nullopt;
-	unordered_set<string>stops(it->route.begin(), it->route.end());
-	const pair<double, double> distance = link_catalog_.CompDistance(it);
+const BusStat& RequestHandler::GetBusStat(catalogue::BusId bus) const {
+	return link_catalog_.GetBusStat(bus);
+}
+
+span<const catalogue::BusId> RequestHandler::GetBusesByStop(catalogue::StopId stop) const {
+	return link_catalog_.GetBusesForStop(stop);
+}
 
-	BusStat bus = { distance.second / distance.first, static_cast<int>(distance.second),
-		static_cast<int>(it->route.size()), static_cast<int>(stops.size()) };
-	return bus;
+vector<catalogue::BusId> RequestHandler::GetDirectBuses(catalogue::StopId from, catalogue::StopId to) const {
+	return link_catalog_.GetDirectBuses(from, to);
 }
 
-const optional<set<string_view>> RequestHandler::GetBusesByStop(const string_view& stop_name) const {
-	string name(stop_name.begin(), stop_name.end());
-	auto it = link_catalog_.FindStop(name);
-	if (!it)
-		return nullopt;
-	
-	set<string_view>buses;
-	for (auto& element : *it) {
-		buses.insert(element);
-	}
-	return buses;
+vector<spatial::Neighbour> RequestHandler::GetNearestStops(geo::Coordinates center, size_t count, double radius) const {
+	return link_catalog_.FindNearestStops(center, count, radius);
 }
\ No newline at end of file
@@ -2,29 +2,31 @@
 
 #include "transport_catalogue.h"
 
-#include <optional>
-#include <set>
-#include <string_view>
+#include <span>
+#include <vector>
 #include <cstdint>
  
-struct BusStat {
-    double curvature = 0;
-    int route_length = 0;
-    int stop_count = 0;
-    int unique_stop_count = 0;
-};
+using BusStat = catalogue::BusStat;
 
  class RequestHandler {
  public:
-     RequestHandler(catalogue::TransportCatalogue& transport_catalogue);
+     RequestHandler(const catalogue::TransportCatalogue& transport_catalogue);
+
+     // Названия в запросах заранее переводятся в id через FindBus и FindStop справочника
 
      // Возвращает информацию о маршруте (запрос Bus)
-     std::optional<BusStat> GetBusStat(const std::string_view& bus_name) const;
+     const BusStat& GetBusStat(catalogue::BusId bus) const;
+
+     // Возвращает маршруты, проходящие через остановку, без копирования
+     std::span<const catalogue::BusId> GetBusesByStop(catalogue::StopId stop) const;
+
+     // Возвращает маршруты, соединяющие две остановки без пересадки (запрос DirectBuses)
+     std::vector<catalogue::BusId> GetDirectBuses(catalogue::StopId from, catalogue::StopId to) const;
 
-     // Возвращает маршруты, проходящие через
-     const std::optional<std::set<std::string_view>> GetBusesByStop(const std::string_view& stop_name) const;
+     // Возвращает ближайшие к точке остановки (запрос NearestStops)
+     std::vector<spatial::Neighbour> GetNearestStops(geo::Coordinates center, size_t count, double radius) const;
 
  private:
      // RequestHandler использует агрегацию объектов "Транспортный Справочник" и "Визуализатор Карты"
-     catalogue::TransportCatalogue& link_catalog_;
+     const catalogue::TransportCatalogue& link_catalog_;
  };
\ No newline at end of file
@@ -1,7 +1,6 @@
 #include "serialization.h"
 
 #include <utility>
-#include <set>
 #include <string_view>
 #include <variant>
 
@@ -16,6 +15,8 @@ void Serialize(const std::string& path, catalogue::TransportCatalogue& transport
 
     SerializeBusesAndStops(transport_catalogue, catalog);
     SerializeSettingsSVG(map, catalog);
+    SerializeSpatialIndex(transport_catalogue, catalog);
+    catalog.set_rendered_map(map.BuildingMap(transport_catalogue).text);
 
     catalog.SerializeToOstream(&fout);
 }
@@ -23,44 +24,48 @@ void Serialize(const std::string& path, catalogue::TransportCatalogue& transport
 void SerializeBusesAndStops(catalogue::TransportCatalogue& transport_catalogue, transport_catalogue_serialize::TransportCatalogue& catalog) {
     for (auto& bus : transport_catalogue.GetBuses()) {
         transport_catalogue_serialize::Bus bus_other;
-        bus_other.set_number_bus(bus.number_bus);
+        bus_other.set_number_bus(bus.number_bus.data(), bus.number_bus.size());
         bus_other.set_is_roundtrip(bus.is_roundtrip);
 
-        for (auto& stop : bus.route) {
-            bus_other.add_route(stop);
-        }
+        *bus_other.mutable_route() = { bus.route.begin(), bus.route.end() };
+
+        const auto& stat = transport_catalogue.GetBusStat(bus.id);
+        bus_other.mutable_stat()->set_curvature(stat.curvature);
+        bus_other.mutable_stat()->set_route_length(stat.route_length);
+        bus_other.mutable_stat()->set_stop_count(stat.stop_count);
+        bus_other.mutable_stat()->set_unique_stop_count(stat.unique_stop_count);
 
         *catalog.add_buses() = bus_other;
     }
 
     for (auto& stop : transport_catalogue.GetStops()) {
         transport_catalogue_serialize::Stop stop_other;
-        stop_other.set_name_stop(stop.name_stop);
+        stop_other.set_name_stop(stop.name_stop.data(), stop.name_stop.size());
         stop_other.set_lat(stop.lat);
         stop_other.set_lng(stop.lng);
 
         *catalog.add_stops() = stop_other;
     }
 
-    for (auto& [stops, distance] : transport_catalogue.GetDistances()) {
+    *catalog.mutable_stops_by_name() = { transport_catalogue.GetStopsByName().begin(), transport_catalogue.GetStopsByName().end() };
+    *catalog.mutable_buses_by_name() = { transport_catalogue.GetBusesByName().begin(), transport_catalogue.GetBusesByName().end() };
+    SerializePerfectHash(transport_catalogue.GetStopHash(), *catalog.mutable_stop_hash());
+    SerializePerfectHash(transport_catalogue.GetBusHash(), *catalog.mutable_bus_hash());
+
+    for (auto& [from, to, distance] : transport_catalogue.GetDistances()) {
         transport_catalogue_serialize::Distance distance_other;
-        distance_other.set_first(stops.first);
-        distance_other.set_last(stops.second);
+        distance_other.set_from(from);
+        distance_other.set_to(to);
         distance_other.set_distance(distance);
 
         *catalog.add_distance() = distance_other;
     }
+}
 
-    for (auto& [stop, buses] : transport_catalogue.GetListBusesForStop()) {
-        transport_catalogue_serialize::BusesForStop buses_for_stop;
-        buses_for_stop.set_stop(stop);
-
-        for (auto& bus : buses) {
-            *buses_for_stop.add_buses() = bus;
-        }
-
-        *catalog.add_list_buses_for_stop() = buses_for_stop;
-    }
+void SerializePerfectHash(const catalogue::PerfectHash& hash, transport_catalogue_serialize::PerfectHash& hash_other) {
+    hash_other.set_seed(hash.GetSeed());
+    *hash_other.mutable_pilots() = { hash.GetPilots().begin(), hash.GetPilots().end() };
+    *hash_other.mutable_ids() = { hash.GetIds().begin(), hash.GetIds().end() };
 }
 
 void SerializeSettingsSVG(renderer::MapRenderer& map, transport_catalogue_serialize::TransportCatalogue& catalog) {
@@ -121,8 +126,22 @@ void SerializeSettingsSVG(renderer::MapRenderer& map, transport_catalogue_serial
     }
 }
 
+void SerializeSpatialIndex(catalogue::TransportCatalogue& transport_catalogue, transport_catalogue_serialize::TransportCatalogue& catalog) {
+    const auto& index = transport_catalogue.GetSpatialIndex();
+    auto catalog_ptr = catalog.mutable_spatial_index();
+
+    catalog_ptr->set_min_lat(index.GetGrid().min_lat);
+    catalog_ptr->set_min_lng(index.GetGrid().min_lng);
+    catalog_ptr->set_cell_lat(index.GetGrid().cell_lat);
+    catalog_ptr->set_cell_lng(index.GetGrid().cell_lng);
+    catalog_ptr->set_rows(index.GetGrid().rows);
+    catalog_ptr->set_cols(index.GetGrid().cols);
+    *catalog_ptr->mutable_cell_offsets() = { index.GetOffsets().begin(), index.GetOffsets().end() };
+    *catalog_ptr->mutable_stop_ids() = { index.GetIds().begin(), index.GetIds().end() };
+}
+
 std::pair<double, double> Deserialize(const std::string& path, catalogue::TransportCatalogue& transport_catalogue,
-    renderer::RenderSettingsSVG& link_settings) {
+    renderer::RenderSettingsSVG& link_settings, json::RawJson& rendered_map) {
 
     std::ifstream fin(path, std::ios::binary);
     transport_catalogue_serialize::TransportCatalogue catalog;
@@ -130,42 +149,40 @@ std::pair<double, double> Deserialize(const std::string& path, catalogue::Transp
 
     DeserializeBusesAndStops(transport_catalogue, catalog);
     DeserializeSettingsSVG(link_settings, catalog);
+    DeserializeSpatialIndex(transport_catalogue, catalog);
+    rendered_map.text = move(*catalog.mutable_rendered_map());
 
     return { catalog.routing_settings().bus_wait_time() ,catalog.routing_settings().bus_velocity() };
 }
 
 void DeserializeBusesAndStops(catalogue::TransportCatalogue& transport_catalogue, transport_catalogue_serialize::TransportCatalogue& catalog) {
-    for (auto& bus : catalog.buses()) {
-        catalogue::Bus bus_other;
-        bus_other.is_roundtrip = bus.is_roundtrip();
-        bus_other.number_bus = bus.number_bus();
-
-        for (auto& stop : bus.route()) {
-            bus_other.route.push_back(stop);
-        }
+    transport_catalogue.GetBuses().reserve(catalog.buses_size());
+    transport_catalogue.GetStops().reserve(catalog.stops_size());
 
-        transport_catalogue.GetBuses().push_back(bus_other);
-        transport_catalogue.GetPointerBus()[transport_catalogue.GetBuses().back().number_bus] = &transport_catalogue.GetBuses().back();
+    for (auto& bus : catalog.buses()) {
+        transport_catalogue.RestoreBus(bus.number_bus(), bus.is_roundtrip(), { bus.route().data(), static_cast<size_t>(bus.route_size()) });
+        transport_catalogue.GetBusStats().push_back({ bus.stat().curvature(), bus.stat().route_length(),
+            bus.stat().stop_count(), bus.stat().unique_stop_count() });
     }
 
     for (auto& stop : catalog.stops()) {
-        transport_catalogue.GetStops().push_back({ stop.name_stop() ,stop.lat() ,stop.lng() });
-        transport_catalogue.GetPointerStop()[transport_catalogue.GetStops().back().name_stop] = &transport_catalogue.GetStops().back();
+        transport_catalogue.RestoreStop(stop.name_stop(), { stop.lat() ,stop.lng() });
     }
+    transport_catalogue.Freeze();
+
+    transport_catalogue.GetStopsByName().assign(catalog.stops_by_name().begin(), catalog.stops_by_name().end());
+    transport_catalogue.GetBusesByName().assign(catalog.buses_by_name().begin(), catalog.buses_by_name().end());
+    DeserializePerfectHash(transport_catalogue.GetStopHash(), catalog.stop_hash());
+    DeserializePerfectHash(transport_catalogue.GetBusHash(), catalog.bus_hash());
 
     for (auto& value : catalog.distance()) {
-        transport_catalogue.GetDistances()[{value.first(), value.last()}] = value.distance();
+        transport_catalogue.GetDistances().push_back({ value.from(), value.to(), value.distance() });
     }
+}
 
-    for (auto& value : catalog.list_buses_for_stop()) {
-        std::set<std::string_view>buses;
-
-        for (auto& bus : value.buses()) {
-            buses.insert(transport_catalogue.GetPointerBus()[bus]->number_bus);
-        }
-
-        transport_catalogue.GetListBusesForStop()[value.stop()] = buses;
-    }
+void DeserializePerfectHash(catalogue::PerfectHash& hash, const transport_catalogue_serialize::PerfectHash& hash_other) {
+    hash.Restore(hash_other.seed(), { hash_other.pilots().begin(), hash_other.pilots().end() },
+        { hash_other.ids().begin(), hash_other.ids().end() });
 }
 
 void DeserializeSettingsSVG(renderer::RenderSettingsSVG& link_settings, transport_catalogue_serialize::TransportCatalogue& catalog) {
@@ -223,4 +240,18 @@ void DeserializeSettingsSVG(renderer::RenderSettingsSVG& link_settings, transpor
                 });
         }
     }
+}
+
+void DeserializeSpatialIndex(catalogue::TransportCatalogue& transport_catalogue, transport_catalogue_serialize::TransportCatalogue& catalog) {
+    const auto& catalog_link = catalog.spatial_index();
+
+    std::vector<geo::Coordinates>points;
+    points.reserve(transport_catalogue.GetStops().size());
+    for (const auto& stop : transport_catalogue.GetStops())
+        points.push_back({ stop.lat,stop.lng });
+
+    transport_catalogue.GetSpatialIndex().Restore({ catalog_link.min_lat(), catalog_link.min_lng(), catalog_link.cell_lat(),
+        catalog_link.cell_lng(), catalog_link.rows(), catalog_link.cols() },
+        { catalog_link.cell_offsets().begin(), catalog_link.cell_offsets().end() },
+        { catalog_link.stop_ids().begin(), catalog_link.stop_ids().end() }, points);
 }
\ No newline at end of file
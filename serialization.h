@@ -11,8 +11,12 @@ void Serialize(const std::string& path, catalogue::TransportCatalogue& transport
 	const double bus_wait_time, const double bus_velocity);
 void SerializeBusesAndStops(catalogue::TransportCatalogue& transport_catalogue, transport_catalogue_serialize::TransportCatalogue& catalog);
 void SerializeSettingsSVG(renderer::MapRenderer& map, transport_catalogue_serialize::TransportCatalogue& catalog);
+void SerializePerfectHash(const catalogue::PerfectHash& hash, transport_catalogue_serialize::PerfectHash& hash_other);
+void SerializeSpatialIndex(catalogue::TransportCatalogue& transport_catalogue, transport_catalogue_serialize::TransportCatalogue& catalog);
 
 std::pair<double, double> Deserialize(const std::string& path, catalogue::TransportCatalogue& transport_catalogue,
-	renderer::RenderSettingsSVG& link_settings);
+	renderer::RenderSettingsSVG& link_settings, json::RawJson& rendered_map);
 void DeserializeBusesAndStops(catalogue::TransportCatalogue& transport_catalogue, transport_catalogue_serialize::TransportCatalogue& catalog);
-void DeserializeSettingsSVG(renderer::RenderSettingsSVG& link_settings, transport_catalogue_serialize::TransportCatalogue& catalog);
\ No newline at end of file
+void DeserializeSettingsSVG(renderer::RenderSettingsSVG& link_settings, transport_catalogue_serialize::TransportCatalogue& catalog);
+void DeserializePerfectHash(catalogue::PerfectHash& hash, const transport_catalogue_serialize::PerfectHash& hash_other);
+void DeserializeSpatialIndex(catalogue::TransportCatalogue& transport_catalogue, transport_catalogue_serialize::TransportCatalogue& catalog);
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "snapshot.h"
+#include "serialization.h"
+
+#include <string_view>
+#include <utility>
+
+using namespace std;
+
+namespace snapshot {
+	namespace {
+		void BuildRouter(CatalogueSnapshot& snapshot, double bus_wait_time, double bus_velocity) {
+			const auto& transport_catalogue = snapshot.transport_catalogue;
+			auto& transport_router = snapshot.transport_router.emplace(bus_wait_time, bus_velocity);
+			auto& weighted_graph = snapshot.weighted_graph = graph::DirectedWeightedGraph<double>(transport_catalogue.GetStops().size());
+
+			for (const auto& bus : transport_catalogue.GetBuses()) {
+				const auto route = bus.GetFullRoute();
+
+				for (size_t i = 0; i < route.size(); ++i) {
+					double weight = bus_wait_time;
+					const string_view from = transport_catalogue.GetStops()[route[i]].name_stop;
+
+					for (size_t u = i + 1; u < route.size(); ++u) {
+						weight += transport_catalogue.GetDistanceBetweenStops(route[u - 1], route[u]) /
+							1000 / bus_velocity * 60.0;
+
+						transport_router.SetEdgeId(weighted_graph.AddEdge(transport_router.AddEdge(from,
+							transport_catalogue.GetStops()[route[u]].name_stop, weight)),
+							bus.number_bus, from, u - i, move(weight));
+					}
+				}
+			}
+
+			snapshot.router.emplace(weighted_graph);
+		}
+	}
+
+	shared_ptr<const CatalogueSnapshot> LoadSnapshot(const string& path) {
+		auto snapshot = make_shared<CatalogueSnapshot>();
+
+		const auto [bus_wait_time, bus_velocity] = Deserialize(path, snapshot->transport_catalogue, snapshot->settings_svg,
+			snapshot->rendered_map);
+		snapshot->transport_catalogue.BuildIndex();
+		BuildRouter(*snapshot, bus_wait_time, bus_velocity);
+
+		return snapshot;
+	}
+
+	shared_ptr<const CatalogueSnapshot> SnapshotHolder::Pin()const {
+		return current_.load(memory_order_acquire);
+	}
+
+	void SnapshotHolder::Publish(shared_ptr<const CatalogueSnapshot> snapshot) {
+		// Предыдущий снимок освобождается здесь или у последнего читателя, который его закрепил
+		current_.store(move(snapshot), memory_order_release);
+	}
+
+	void SnapshotHolder::Reload(const string& path) {
+		Publish(LoadSnapshot(path));
+	}
+}
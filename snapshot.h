@@ -0,0 +1,47 @@
+#pragma once
+
+#include "transport_catalogue.h"
+#include "map_renderer.h"
+#include "transport_router.h"
+#include "graph.h"
+#include "router.h"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace snapshot {
+	// Неизменяемый снимок базы: справочник, настройки и готовая карта, маршрутизатор.
+	// Маршрутизатор ссылается на граф и названия справочника, поэтому снимок не копируется
+	struct CatalogueSnapshot {
+		CatalogueSnapshot() = default;
+		CatalogueSnapshot(const CatalogueSnapshot&) = delete;
+		CatalogueSnapshot& operator=(const CatalogueSnapshot&) = delete;
+
+		catalogue::TransportCatalogue transport_catalogue;
+		renderer::RenderSettingsSVG settings_svg;
+		// Карта отрисовывается один раз при создании базы и отдаётся всем запросам Map
+		json::RawJson rendered_map;
+		std::optional<router::TransportRouter> transport_router;
+		graph::DirectedWeightedGraph<double> weighted_graph;
+		std::optional<graph::Router<double>> router;
+	};
+
+	// Загружает базу, созданную make_base, и строит по ней маршрутизатор
+	std::shared_ptr<const CatalogueSnapshot> LoadSnapshot(const std::string& path);
+
+	// Хранилище текущего снимка для долгоживущего процесса.
+	// Читатели закрепляют снимок через Pin и работают с ним без блокировок справочника,
+	// загрузчик атомарно публикует новый. Старый снимок освобождается последним читателем
+	class SnapshotHolder {
+	public:
+		std::shared_ptr<const CatalogueSnapshot> Pin()const;
+		void Publish(std::shared_ptr<const CatalogueSnapshot> snapshot);
+		// Загружает базу в вызывающем потоке и публикует её, текущие читатели не ждут
+		void Reload(const std::string& path);
+
+	private:
+		std::atomic<std::shared_ptr<const CatalogueSnapshot>>current_;
+	};
+}
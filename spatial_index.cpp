@@ -0,0 +1,158 @@
+#define _USE_MATH_DEFINES
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <tuple>
+#include <utility>
+
+using namespace std;
+
+namespace spatial {
+	namespace {
+		const double METERS_PER_DEGREE = RADIUS * 3.1415926535 / 180.;
+		const double POINTS_PER_CELL = 4;
+		const double MIN_SPAN = 1e-9;
+
+		bool CloserThan(const Neighbour& lhs, const Neighbour& rhs) {
+			return tie(lhs.distance, lhs.id) < tie(rhs.distance, rhs.id);
+		}
+	}
+
+	void GridIndex::Build(const vector<geo::Coordinates>& points) {
+		grid_ = {};
+		offsets_.assign(1, 0);
+		ids_.clear();
+		points_.clear();
+		if (points.empty())
+			return;
+
+		const auto [bottom, top] = minmax_element(points.begin(), points.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.lat < rhs.lat;
+			});
+		const auto [left, right] = minmax_element(points.begin(), points.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.lng < rhs.lng;
+			});
+
+		// Подбираем почти квадратные в метрах ячейки
+		const double lat_span = max(top->lat - bottom->lat, MIN_SPAN);
+		const double lng_span = max(right->lng - left->lng, MIN_SPAN);
+		const double lng_scale = max(cos((top->lat + bottom->lat) / 2 * 3.1415926535 / 180.), MIN_SPAN);
+		const double cells = max(1.0, points.size() / POINTS_PER_CELL);
+		const double side = sqrt(lat_span * lng_span * lng_scale / cells);
+
+		grid_.min_lat = bottom->lat;
+		grid_.min_lng = left->lng;
+		grid_.rows = static_cast<uint32_t>(clamp(ceil(lat_span / side), 1.0, cells));
+		grid_.cols = static_cast<uint32_t>(clamp(ceil(lng_span * lng_scale / side), 1.0, cells));
+		grid_.cell_lat = lat_span / grid_.rows;
+		grid_.cell_lng = lng_span / grid_.cols;
+
+		vector<uint32_t>cell_of(points.size());
+		offsets_.assign(static_cast<size_t>(grid_.rows) * grid_.cols + 1, 0);
+		for (size_t i = 0; i < points.size(); ++i) {
+			cell_of[i] = GetRow(points[i].lat) * grid_.cols + GetCol(points[i].lng);
+			++offsets_[cell_of[i] + 1];
+		}
+		partial_sum(offsets_.begin(), offsets_.end(), offsets_.begin());
+
+		vector<uint32_t>position(offsets_.begin(), prev(offsets_.end()));
+		ids_.resize(points.size());
+		points_.resize(points.size());
+		for (size_t i = 0; i < points.size(); ++i) {
+			ids_[position[cell_of[i]]] = static_cast<uint32_t>(i);
+			points_[position[cell_of[i]]++] = points[i];
+		}
+	}
+
+	void GridIndex::Restore(Grid grid, vector<uint32_t> offsets, vector<uint32_t> ids, const vector<geo::Coordinates>& points) {
+		grid_ = grid;
+		offsets_ = move(offsets);
+		ids_ = move(ids);
+		points_.clear();
+		points_.reserve(ids_.size());
+		for (const uint32_t id : ids_)
+			points_.push_back(points.at(id));
+	}
+
+	vector<Neighbour> GridIndex::FindNearest(geo::Coordinates center, size_t count, double radius)const {
+		vector<Neighbour>result;
+		if (ids_.empty())
+			return result;
+
+		// Нижняя оценка расстояния до ячеек следующего кольца
+		const double max_lat = max({ abs(grid_.min_lat), abs(grid_.min_lat + grid_.cell_lat * grid_.rows), abs(center.lat) });
+		const double lng_scale = max(cos(min(max_lat, 90.0) * 3.1415926535 / 180.), 0.0);
+		const double ring_step = min(grid_.cell_lat, grid_.cell_lng * lng_scale) * METERS_PER_DEGREE;
+
+		const long long row = GetRow(center.lat);
+		const long long col = GetCol(center.lng);
+		const long long max_ring = max(grid_.rows, grid_.cols);
+
+		auto visit_cell = [&](long long r, long long c) {
+			if (r < 0 || c < 0 || r >= grid_.rows || c >= grid_.cols)
+				return;
+			const size_t cell = static_cast<size_t>(r) * grid_.cols + static_cast<size_t>(c);
+			for (uint32_t i = offsets_[cell]; i < offsets_[cell + 1]; ++i) {
+				const Neighbour candidate = { ids_[i], geo::ComputeDistance(center, points_[i]) };
+				if (!(candidate.distance <= radius))
+					continue;
+				if (count == 0 || result.size() < count) {
+					result.push_back(candidate);
+					push_heap(result.begin(), result.end(), CloserThan);
+				}
+				else if (CloserThan(candidate, result.front())) {
+					pop_heap(result.begin(), result.end(), CloserThan);
+					result.back() = candidate;
+					push_heap(result.begin(), result.end(), CloserThan);
+				}
+			}
+		};
+
+		for (long long ring = 0; ring <= max_ring; ++ring) {
+			for (long long r = row - ring; r <= row + ring; ++r) {
+				if (r == row - ring || r == row + ring) {
+					for (long long c = col - ring; c <= col + ring; ++c)
+						visit_cell(r, c);
+				}
+				else {
+					visit_cell(r, col - ring);
+					if (ring)
+						visit_cell(r, col + ring);
+				}
+			}
+
+			const double bound = ring * ring_step;
+			if (bound > radius)
+				break;
+			if (count && result.size() == count && result.front().distance <= bound)
+				break;
+		}
+
+		sort_heap(result.begin(), result.end(), CloserThan);
+		return result;
+	}
+
+	const Grid& GridIndex::GetGrid()const {
+		return grid_;
+	}
+
+	const vector<uint32_t>& GridIndex::GetOffsets()const {
+		return offsets_;
+	}
+
+	const vector<uint32_t>& GridIndex::GetIds()const {
+		return ids_;
+	}
+
+	uint32_t GridIndex::GetRow(double lat)const {
+		const double row = floor((lat - grid_.min_lat) / grid_.cell_lat);
+		return static_cast<uint32_t>(clamp(row, 0.0, grid_.rows - 1.0));
+	}
+
+	uint32_t GridIndex::GetCol(double lng)const {
+		const double col = floor((lng - grid_.min_lng) / grid_.cell_lng);
+		return static_cast<uint32_t>(clamp(col, 0.0, grid_.cols - 1.0));
+	}
+}
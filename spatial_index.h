@@ -0,0 +1,51 @@
+#pragma once
+
+#include "geo.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace spatial {
+	struct Neighbour {
+		uint32_t id;
+		double distance;
+	};
+
+	// Параметры равномерной сетки по широте и долготе
+	struct Grid {
+		double min_lat = 0;
+		double min_lng = 0;
+		double cell_lat = 1;
+		double cell_lng = 1;
+		uint32_t rows = 0;
+		uint32_t cols = 0;
+	};
+
+	// Статический пространственный индекс: точки разложены по ячейкам сетки в формате CSR.
+	// Строится один раз при создании базы, в среднем на ячейку приходится несколько точек.
+	class GridIndex {
+	public:
+		void Build(const std::vector<geo::Coordinates>& points);
+		void Restore(Grid grid, std::vector<uint32_t> offsets, std::vector<uint32_t> ids, const std::vector<geo::Coordinates>& points);
+
+		// Не более count ближайших точек (0 - без ограничения) на расстоянии не больше radius,
+		// упорядоченные по возрастанию расстояния
+		std::vector<Neighbour> FindNearest(geo::Coordinates center, size_t count,
+			double radius = std::numeric_limits<double>::infinity())const;
+
+		const Grid& GetGrid()const;
+		const std::vector<uint32_t>& GetOffsets()const;
+		const std::vector<uint32_t>& GetIds()const;
+
+	private:
+		uint32_t GetRow(double lat)const;
+		uint32_t GetCol(double lng)const;
+
+		Grid grid_;
+		std::vector<uint32_t>offsets_;
+		std::vector<uint32_t>ids_;
+		// Координаты в том же порядке, что и ids_
+		std::vector<geo::Coordinates>points_;
+	};
+}
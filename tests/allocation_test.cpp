@@ -0,0 +1,72 @@
+// Запросы Bus и Stop к готовому справочнику не должны выделять память
+#include "transport_catalogue.h"
+#include "request_handler.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+namespace {
+	size_t allocation_count = 0;
+}
+
+void* operator new(size_t size) {
+	++allocation_count;
+	if (void* ptr = malloc(size ? size : 1))
+		return ptr;
+	throw bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	free(ptr);
+}
+
+int main() {
+	catalogue::TransportCatalogue transport_catalogue;
+	const vector<catalogue::StopDescription>stops = {
+		{ "Tolstopaltsevo", { 55.611087, 37.20829 }, { { "Marushkino", 3900 } } },
+		{ "Marushkino", { 55.595884, 37.209755 }, { { "Rasskazovka", 9900 } } },
+		{ "Rasskazovka", { 55.632761, 37.333324 }, {} },
+		{ "Biryulyovo", { 55.574371, 37.6517 }, { { "Marushkino", 2600 } } },
+	};
+	const vector<catalogue::BusDescription>buses = {
+		{ "750", { "Tolstopaltsevo", "Marushkino", "Rasskazovka" }, false },
+		{ "256", { "Biryulyovo", "Marushkino", "Biryulyovo" }, true },
+	};
+	transport_catalogue.AddStopsAndBuses(stops, buses);
+	transport_catalogue.Freeze();
+	transport_catalogue.BuildNameIndex();
+	transport_catalogue.BuildIndex();
+	transport_catalogue.ComputeBusStats();
+
+	const RequestHandler handler(transport_catalogue);
+	// Попадания и промахи
+	const string_view bus_names[] = { "750"sv, "751"sv };
+	const string_view stop_names[] = { "Marushkino"sv, "Marushkin"sv };
+
+	const size_t before = allocation_count;
+	size_t answers = 0;
+	for (int i = 0; i < 1000; ++i) {
+		for (const string_view bus_name : bus_names)
+			if (const catalogue::Bus* bus = transport_catalogue.FindBus(bus_name))
+				answers += handler.GetBusStat(bus->id).stop_count > 0;
+		for (const string_view stop_name : stop_names)
+			if (const catalogue::Stop* stop = transport_catalogue.FindStop(stop_name))
+				answers += !handler.GetBusesByStop(stop->id).empty();
+	}
+	const size_t allocations = allocation_count - before;
+
+	if (answers != 2000 || allocations != 0) {
+		cerr << "answers: "s << answers << ", allocations: "s << allocations << endl;
+		return 1;
+	}
+}
@@ -0,0 +1,32 @@
+// Построение совершенной хеш-функции: различные ключи находятся, повторяющиеся сразу отвергаются
+#include "perfect_hash.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+int main() {
+	catalogue::PerfectHash hash;
+	const vector<string_view>keys = { "750"sv, "256"sv, "828"sv, "Tolstopaltsevo"sv, "Marushkino"sv };
+	hash.Build(keys);
+	for (uint32_t id = 0; id < keys.size(); ++id) {
+		if (hash.Find(keys[id]) != id) {
+			cerr << "key "s << keys[id] << " is not found"s << endl;
+			return 1;
+		}
+	}
+
+	// Без предварительной проверки подбор смещений перебирает все seed и зависает
+	try {
+		hash.Build({ "750"sv, "256"sv, "750"sv });
+	}
+	catch (const invalid_argument&) {
+		return 0;
+	}
+	cerr << "repeated key is accepted"s << endl;
+	return 1;
+}
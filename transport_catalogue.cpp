@@ -1,148 +1,477 @@
 #include "transport_catalogue.h"
 #include "geo.h"
+#include "parallel.h"
 
 #include <string>
 #include <utility>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <bit>
+#include <limits>
 
 using namespace std;
 
 namespace catalogue {
-	void TransportCatalogue::AddBusRing(string& str, int idx) {
-		str += " >";
-		string name = {};
-		for (; static_cast<size_t>(idx) < str.size(); ++idx) {
-			if (str[idx] != '>')
-				name += str[idx];
-			else {
-				name.pop_back();
-				list_buses_for_stop_[name].insert(buses_.back().number_bus);
-				buses_.back().route.push_back(move(name));
-				name.clear();
-				++idx;
-			}
+	namespace {
+		template <typename Id, typename Items, typename Name>
+		span<const Id> FindByPrefix(const vector<Id>& sorted, const Items& items, Name name, string_view prefix, size_t count) {
+			const auto first = lower_bound(sorted.begin(), sorted.end(), prefix, [&](Id id, string_view value) {
+				return string_view(items[id].*name) < value;
+				});
+			auto last = first;
+			for (; last != sorted.end() && count && string_view(items[*last].*name).starts_with(prefix); ++last, --count) {}
+			return { first, last };
 		}
+
+		const StopId UNKNOWN_STOP = numeric_limits<StopId>::max();
 	}
 
-	void TransportCatalogue::AddBusStraight(string& str, int idx) {
-		str += " `";
-		string name = {};
-		for (; static_cast<size_t>(idx) < str.size(); ++idx) {
-			if (str[idx] != '`')
-				name += str[idx];
-			else {
-				name.pop_back();
-				list_buses_for_stop_[name].insert(buses_.back().number_bus);
-				buses_.back().route.push_back(move(name));
-				name.clear();
-				++idx;
-			}
+	void DistanceTable::Build(size_t stop_count, const vector<Record>& records) {
+		offsets_.assign(stop_count + 1, 0);
+		for (const auto& record : records)
+			++offsets_[min(record.from, record.to) + 1];
+		partial_sum(offsets_.begin(), offsets_.end(), offsets_.begin());
+
+		vector<uint32_t>position(offsets_.begin(), prev(offsets_.end()));
+		entries_.resize(records.size());
+		for (const auto& record : records) {
+			const StopId row = min(record.from, record.to);
+			const uint32_t key = (max(record.from, record.to) << 1) | (record.from > record.to ? 1u : 0u);
+			entries_[position[row]++] = { key,record.distance };
 		}
-		const int size = static_cast<int>(buses_.back().route.size());
-		for (int i = size - 2; i >= 0; --i)
-			buses_.back().route.push_back(buses_.back().route[i]);
-	}
-
-	void TransportCatalogue::ParseBus(string& str) {
-		string number = {};
-		int idx = 0;
-		while (str[idx] != ':')
-			number += str[idx++];
-		bool flag = static_cast<int>(str.find('>')) == -1;
-		buses_.push_back({ number,!flag });
-		pointer_bus_[buses_.back().number_bus] = &buses_.back();
-		idx += 2;
-		if (flag)
-			AddBusStraight(str, idx);
-		else
-			AddBusRing(str, idx);
-	}
-
-	void TransportCatalogue::SetDistanceBetweenStops(string& str, string& name, int idx, int right_idx) {
-		while (str[right_idx] == '~') {
-			idx = right_idx + 2;
-			right_idx = str.find('m', idx);
-			const string distance(str.begin() + idx, str.begin() + right_idx);
-			idx = right_idx + 2;
-			right_idx = str.find('~', idx);
-			if (right_idx == -1)
-				right_idx = str.size();
-			const string to_stop(str.begin() + idx, str.begin() + right_idx);
-			distance_[{name, to_stop}] = stod(distance);
+
+		for (size_t row = 0; row < stop_count; ++row) {
+			sort(entries_.begin() + offsets_[row], entries_.begin() + offsets_[row + 1], [](const Entry& lhs, const Entry& rhs) {
+				return lhs.key < rhs.key;
+				});
 		}
 	}
 
-	void TransportCatalogue::AddStop(string& str, double lat, double lng) {
-		string name = {};
-		int idx = 0;
-		while (str[idx] != ':')
-			name += str[idx++];
-		idx += 2;
-		int right_idx = idx + 1;
-		right_idx = str.find(',', right_idx);
-		idx = right_idx + 2;
-		right_idx = str.find('~', idx);
-		if (right_idx == -1)
-			right_idx = str.size();
-		
-		SetDistanceBetweenStops(str, name, idx, right_idx);
-		stops_.push_back({ move(name),lat,lng });
-		pointer_stop_[stops_.back().name_stop] = &stops_.back();
+	double DistanceTable::Get(StopId from, StopId to)const {
+		const StopId row = min(from, to);
+		const uint32_t neighbour = max(from, to) << 1;
+		const uint32_t key = neighbour | (from > to ? 1u : 0u);
+
+		const auto last = entries_.begin() + offsets_.at(row + 1);
+		auto it = lower_bound(entries_.begin() + offsets_[row], last, neighbour, [](const Entry& entry, uint32_t value) {
+			return entry.key < value;
+			});
+		if (it == last || (it->key >> 1) != (neighbour >> 1))
+			throw out_of_range("Distance between stops is not set");
+
+		// Если расстояние в нужном направлении не задано, используем обратное
+		if (it->key != key && next(it) != last && next(it)->key == key)
+			++it;
+		return it->distance;
+	}
+
+	StopId TransportCatalogue::RegisterStop(string name) {
+		if (frozen_)
+			throw logic_error("Catalogue is frozen");
+		const StopId id = static_cast<StopId>(stops_.size());
+		stops_.push_back({ name_storage_.emplace_back(move(name)), 0, 0, id });
+		pointer_stop_[stops_.back().name_stop] = id;
+		return id;
+	}
+
+	StopId TransportCatalogue::GetStopId(string_view name) {
+		if (const Stop* stop = FindStop(name))
+			return stop->id;
+		return RegisterStop(string(name));
+	}
+
+	BusId TransportCatalogue::RegisterBus(string number, bool is_roundtrip) {
+		if (frozen_)
+			throw logic_error("Catalogue is frozen");
+		const BusId id = static_cast<BusId>(buses_.size());
+		buses_.push_back({ name_storage_.emplace_back(move(number)), is_roundtrip, {}, id });
+		route_storage_.emplace_back();
+		pointer_bus_[buses_.back().number_bus] = id;
+		return id;
+	}
+
+	void TransportCatalogue::AddBus(string_view number, span<const string_view> stops, bool is_roundtrip) {
+		const BusId id = RegisterBus(string(number), is_roundtrip);
+
+		auto& route = route_storage_[id];
+		route.reserve(stops.size());
+		for (const string_view stop : stops)
+			route.push_back(GetStopId(stop));
+		buses_[id].route = route;
+	}
+
+	void TransportCatalogue::RestoreStop(string_view name, geo::Coordinates coords) {
+		if (frozen_)
+			throw logic_error("Catalogue is frozen");
+		stops_.push_back({ name_storage_.emplace_back(name), coords.lat, coords.lng, static_cast<StopId>(stops_.size()) });
+	}
+
+	void TransportCatalogue::RestoreBus(string_view number, bool is_roundtrip, span<const StopId> route) {
+		if (frozen_)
+			throw logic_error("Catalogue is frozen");
+		buses_.push_back({ name_storage_.emplace_back(number), is_roundtrip,
+			route_storage_.emplace_back(route.begin(), route.end()), static_cast<BusId>(buses_.size()) });
+	}
+
+	void TransportCatalogue::Freeze() {
+		if (frozen_)
+			return;
+
+		size_t names_size = 0;
+		size_t routes_size = 0;
+		for (const auto& stop : stops_)
+			names_size += stop.name_stop.size();
+		for (const auto& bus : buses_) {
+			names_size += bus.number_bus.size();
+			routes_size += bus.route.size();
+		}
+
+		// Память резервируется заранее, поэтому ссылки на неё остаются действительными
+		names_.reserve(names_size);
+		routes_.reserve(routes_size);
+		const auto pack_name = [this](string_view name) {
+			const size_t offset = names_.size();
+			names_.insert(names_.end(), name.begin(), name.end());
+			return string_view(names_.data() + offset, name.size());
+		};
+
+		for (auto& stop : stops_)
+			stop.name_stop = pack_name(stop.name_stop);
+		for (auto& bus : buses_) {
+			bus.number_bus = pack_name(bus.number_bus);
+			const size_t offset = routes_.size();
+			routes_.insert(routes_.end(), bus.route.begin(), bus.route.end());
+			bus.route = { routes_.data() + offset, bus.route.size() };
+		}
+
+		stops_.shrink_to_fit();
+		buses_.shrink_to_fit();
+
+		// Индексы названий загрузки ссылаются на промежуточное хранилище
+		if (!pointer_stop_.empty() || !pointer_bus_.empty()) {
+			pointer_stop_.clear();
+			pointer_bus_.clear();
+			for (const auto& stop : stops_)
+				pointer_stop_[stop.name_stop] = stop.id;
+			for (const auto& bus : buses_)
+				pointer_bus_[bus.number_bus] = bus.id;
+		}
+
+		name_storage_ = {};
+		route_storage_ = {};
+		frozen_ = true;
+	}
+
+	void TransportCatalogue::SetDistanceBetweenStops(string_view from, string_view to, double distance) {
+		distances_.push_back({ GetStopId(from),GetStopId(to),distance });
+	}
+
+	void TransportCatalogue::AddStop(string_view name, geo::Coordinates coords, span<const pair<string_view, double>> distances) {
+		const StopId id = GetStopId(name);
+		stops_[id].lat = coords.lat;
+		stops_[id].lng = coords.lng;
+
+		for (const auto& [to_stop, distance] : distances)
+			distances_.push_back({ id,GetStopId(to_stop),distance });
+	}
+
+	void TransportCatalogue::AddStopsAndBuses(span<const StopDescription> stops, span<const BusDescription> buses, size_t thread_count) {
+		if (!thread_count)
+			thread_count = parallel::DefaultThreadCount();
+
+		// Фаза 1: строки копируются параллельно, а в индекс названий вносятся по порядку входных данных
+		vector<string>stop_names(stops.size());
+		parallel::ForEachChunk(stops.size(), thread_count, [&](size_t begin, size_t end, size_t) {
+			for (size_t i = begin; i < end; ++i)
+				stop_names[i] = stops[i].name;
+			});
+		vector<string>bus_names(buses.size());
+		parallel::ForEachChunk(buses.size(), thread_count, [&](size_t begin, size_t end, size_t) {
+			for (size_t i = begin; i < end; ++i)
+				bus_names[i] = buses[i].name;
+			});
+
+		pointer_stop_.reserve(pointer_stop_.size() + stops.size());
+		stops_.reserve(stops_.size() + stops.size());
+		vector<StopId>stop_ids(stops.size());
+		for (size_t i = 0; i < stops.size(); ++i) {
+			const Stop* stop = FindStop(stop_names[i]);
+			stop_ids[i] = stop ? stop->id : RegisterStop(move(stop_names[i]));
+		}
+
+		// Из повторных описаний одной остановки действует последнее
+		vector<size_t>last_description(stops_.size(), stops.size());
+		for (size_t i = 0; i < stops.size(); ++i)
+			last_description[stop_ids[i]] = i;
+		vector<size_t>described;
+		described.reserve(stops.size());
+		for (size_t i = 0; i < stops.size(); ++i)
+			if (last_description[stop_ids[i]] == i)
+				described.push_back(i);
+
+		// Из автобусов с одинаковым номером остаётся последний
+		unordered_map<string_view, size_t>last_bus;
+		last_bus.reserve(buses.size());
+		for (size_t i = 0; i < buses.size(); ++i)
+			last_bus[buses[i].name] = i;
+
+		pointer_bus_.reserve(pointer_bus_.size() + last_bus.size());
+		buses_.reserve(buses_.size() + last_bus.size());
+		// Описание автобуса и его id
+		vector<pair<size_t, BusId>>kept_buses;
+		kept_buses.reserve(last_bus.size());
+		for (size_t i = 0; i < buses.size(); ++i) {
+			if (last_bus[buses[i].name] != i)
+				continue;
+			if (const Bus* bus = FindBus(bus_names[i])) {
+				buses_[bus->id].is_roundtrip = buses[i].is_roundtrip;
+				route_storage_[bus->id].clear();
+				kept_buses.push_back({ i, bus->id });
+			}
+			else
+				kept_buses.push_back({ i, RegisterBus(move(bus_names[i]), buses[i].is_roundtrip) });
+		}
+
+		// Фаза 2: индексы названий только читаются, каждая часть пишет в свои элементы
+		vector<vector<DistanceTable::Record>>distance_parts(thread_count);
+		vector<char>has_unknown(thread_count, 0);
+
+		parallel::ForEachChunk(described.size(), thread_count, [&](size_t begin, size_t end, size_t part) {
+			auto& records = distance_parts[part];
+			for (size_t k = begin; k < end; ++k) {
+				const size_t i = described[k];
+				Stop& stop = stops_[stop_ids[i]];
+				stop.lat = stops[i].coords.lat;
+				stop.lng = stops[i].coords.lng;
+
+				// Расстояния до неописанных остановок отбрасываются
+				for (const auto& [to_stop, distance] : stops[i].distances)
+					if (const Stop* to = FindStop(to_stop))
+						records.push_back({ stop.id,to->id,distance });
+			}
+			});
+
+		parallel::ForEachChunk(kept_buses.size(), thread_count, [&](size_t begin, size_t end, size_t part) {
+			for (size_t k = begin; k < end; ++k) {
+				const auto [i, id] = kept_buses[k];
+				auto& route = route_storage_[id];
+				const auto& names = buses[i].stops;
+
+				route.reserve(names.size());
+				for (const string_view name : names) {
+					const Stop* stop = FindStop(name);
+					has_unknown[part] |= !stop;
+					route.push_back(stop ? stop->id : UNKNOWN_STOP);
+				}
+				buses_[id].route = route;
+			}
+			});
+
+		if (find(has_unknown.begin(), has_unknown.end(), 1) != has_unknown.end())
+			throw invalid_argument("Route stop is referenced but not described");
+
+		// Слияние частей в порядке их номеров
+		for (const auto& records : distance_parts)
+			distances_.insert(distances_.end(), records.begin(), records.end());
 	}
 
-	Bus* TransportCatalogue::FindBus(const string& number) const {
-		if (pointer_bus_.count(number))
-			return pointer_bus_.at(number);
-		else
-			return nullptr;
+	const Bus* TransportCatalogue::FindBus(string_view number) const {
+		if (!bus_hash_.GetIds().empty()) {
+			const uint32_t id = bus_hash_.Find(number);
+			return buses_[id].number_bus == number ? &buses_[id] : nullptr;
+		}
+		const auto it = pointer_bus_.find(number);
+		return it == pointer_bus_.end() ? nullptr : &buses_[it->second];
 	}
 
 	pair<double, double> TransportCatalogue::CompDistance(const Bus* it) {
-		double geographical_distance = 0;
+		// Географическое расстояние симметрично, поэтому обратный путь равен прямому
+		double geographical_distance = geo::ComputeRouteDistance(stop_coords_, it->route);
+		if (!it->is_roundtrip)
+			geographical_distance *= 2;
+
+		const RouteView route = it->GetFullRoute();
 		double actual_distance = 0;
-		for (size_t i = 0; i + 1 < it->route.size(); ++i) {
-			geographical_distance += geo::ComputeDistance({ pointer_stop_[it->route[i]]->lat,pointer_stop_[it->route[i]]->lng },
-				{ pointer_stop_[it->route[i + 1]]->lat,pointer_stop_[it->route[i + 1]]->lng });
-			actual_distance += GetDistanceBetweenStops(it->route[i], it->route[i + 1]);
-		}
+		for (size_t i = 0; i + 1 < route.size(); ++i)
+			actual_distance += GetDistanceBetweenStops(route[i], route[i + 1]);
 
 		return { geographical_distance,actual_distance };
 	}
 
-	set<string_view>* TransportCatalogue::FindStop(const string& name) {
-		if (pointer_stop_[name] == nullptr)
-			return nullptr;
-		else
-			return &list_buses_for_stop_[name];
+	const Stop* TransportCatalogue::FindStop(string_view name)const {
+		if (!stop_hash_.GetIds().empty()) {
+			const uint32_t id = stop_hash_.Find(name);
+			return stops_[id].name_stop == name ? &stops_[id] : nullptr;
+		}
+		const auto it = pointer_stop_.find(name);
+		return it == pointer_stop_.end() ? nullptr : &stops_[it->second];
+	}
+
+	span<const BusId> TransportCatalogue::GetBusesForStop(StopId id)const {
+		return { stop_buses_.data() + stop_buses_offsets_[id], stop_buses_.data() + stop_buses_offsets_[id + 1] };
 	}
 
-	double TransportCatalogue::GetDistanceBetweenStops(const std::string& from, const std::string& to) const {
-		if (distance_.count({ from,to }))
-			return distance_.at({ from,to });
-		else
-			return distance_.at({ to,from });
+	double TransportCatalogue::GetDistanceBetweenStops(StopId from, StopId to) const {
+		return distance_table_.Get(from, to);
 	}
 
-	deque<Bus>& TransportCatalogue::GetBuses() {
+	void TransportCatalogue::BuildIndex() {
+		stop_coords_ = {};
+		stop_coords_.Reserve(stops_.size());
+		for (const auto& stop : stops_)
+			stop_coords_.Add({ stop.lat,stop.lng });
+
+		distance_table_.Build(stops_.size(), distances_);
+
+		vector<vector<StopId>>unique_stops(buses_.size());
+		parallel::ForEachChunk(buses_.size(), parallel::DefaultThreadCount(), [&](size_t begin, size_t end, size_t) {
+			for (size_t i = begin; i < end; ++i) {
+				auto& stops = unique_stops[i];
+				stops.assign(buses_[i].route.begin(), buses_[i].route.end());
+				sort(stops.begin(), stops.end());
+				stops.erase(unique(stops.begin(), stops.end()), stops.end());
+			}
+			});
+
+		stop_buses_offsets_.assign(stops_.size() + 1, 0);
+		for (const auto& stops : unique_stops)
+			for (const StopId stop : stops)
+				++stop_buses_offsets_[stop + 1];
+		partial_sum(stop_buses_offsets_.begin(), stop_buses_offsets_.end(), stop_buses_offsets_.begin());
+
+		// Автобусы обходятся в порядке названий, поэтому списки остановок получаются отсортированными
+		vector<uint32_t>position(stop_buses_offsets_.begin(), prev(stop_buses_offsets_.end()));
+		stop_buses_.resize(stop_buses_offsets_.back());
+		bus_words_ = (buses_.size() + 63) / 64;
+		stop_bus_bits_.assign(stops_.size() * bus_words_, 0);
+		for (size_t rank = 0; rank < buses_by_name_.size(); ++rank) {
+			for (const StopId stop : unique_stops[buses_by_name_[rank]]) {
+				stop_buses_[position[stop]++] = buses_by_name_[rank];
+				stop_bus_bits_[stop * bus_words_ + rank / 64] |= uint64_t{ 1 } << (rank % 64);
+			}
+		}
+	}
+
+	vector<spatial::Neighbour> TransportCatalogue::FindNearestStops(geo::Coordinates center, size_t count, double radius)const {
+		return spatial_index_.FindNearest(center, count, radius);
+	}
+
+	void TransportCatalogue::BuildSpatialIndex() {
+		vector<geo::Coordinates>points;
+		points.reserve(stops_.size());
+		for (const auto& stop : stops_)
+			points.push_back({ stop.lat,stop.lng });
+		spatial_index_.Build(points);
+	}
+
+	span<const StopId> TransportCatalogue::SuggestStops(string_view prefix, size_t count)const {
+		return FindByPrefix(stops_by_name_, stops_, &Stop::name_stop, prefix, count);
+	}
+
+	span<const BusId> TransportCatalogue::SuggestBuses(string_view prefix, size_t count)const {
+		return FindByPrefix(buses_by_name_, buses_, &Bus::number_bus, prefix, count);
+	}
+
+	void TransportCatalogue::BuildNameIndex() {
+		stops_by_name_.resize(stops_.size());
+		iota(stops_by_name_.begin(), stops_by_name_.end(), 0);
+		sort(stops_by_name_.begin(), stops_by_name_.end(), [this](StopId lhs, StopId rhs) {
+			return stops_[lhs].name_stop < stops_[rhs].name_stop;
+			});
+
+		buses_by_name_.resize(buses_.size());
+		iota(buses_by_name_.begin(), buses_by_name_.end(), 0);
+		sort(buses_by_name_.begin(), buses_by_name_.end(), [this](BusId lhs, BusId rhs) {
+			return buses_[lhs].number_bus < buses_[rhs].number_bus;
+			});
+
+		vector<string_view>names;
+		names.reserve(stops_.size());
+		for (const auto& stop : stops_)
+			names.push_back(stop.name_stop);
+		stop_hash_.Build(names);
+
+		names.clear();
+		for (const auto& bus : buses_)
+			names.push_back(bus.number_bus);
+		bus_hash_.Build(names);
+
+		pointer_stop_ = {};
+		pointer_bus_ = {};
+	}
+
+	vector<BusId> TransportCatalogue::GetDirectBuses(StopId from, StopId to)const {
+		vector<BusId>result;
+		const uint64_t* from_bits = stop_bus_bits_.data() + from * bus_words_;
+		const uint64_t* to_bits = stop_bus_bits_.data() + to * bus_words_;
+
+		for (size_t word = 0; word < bus_words_; ++word) {
+			for (uint64_t bits = from_bits[word] & to_bits[word]; bits; bits &= bits - 1)
+				result.push_back(buses_by_name_[word * 64 + countr_zero(bits)]);
+		}
+		return result;
+	}
+
+	void TransportCatalogue::ComputeBusStats() {
+		bus_stats_.clear();
+		bus_stats_.reserve(buses_.size());
+		for (const auto& bus : buses_) {
+			vector<StopId>unique_stops(bus.route.begin(), bus.route.end());
+			sort(unique_stops.begin(), unique_stops.end());
+			unique_stops.erase(unique(unique_stops.begin(), unique_stops.end()), unique_stops.end());
+			const pair<double, double> distance = CompDistance(&bus);
+
+			bus_stats_.push_back({ distance.second / distance.first, static_cast<int>(distance.second),
+				static_cast<int>(bus.GetFullRoute().size()), static_cast<int>(unique_stops.size()) });
+		}
+	}
+
+	const BusStat& TransportCatalogue::GetBusStat(BusId id)const {
+		return bus_stats_[id];
+	}
+
+	vector<Bus>& TransportCatalogue::GetBuses() {
+		return buses_;
+	}
+
+	const vector<Bus>& TransportCatalogue::GetBuses()const {
 		return buses_;
 	}
 
-	deque<Stop>& TransportCatalogue::GetStops(){
+	vector<Stop>& TransportCatalogue::GetStops(){
+		return stops_;
+	}
+
+	const vector<Stop>& TransportCatalogue::GetStops()const {
 		return stops_;
 	}
 
-	std::unordered_map<std::string_view, Stop*>& TransportCatalogue::GetPointerStop() {
-		return pointer_stop_;
+	PerfectHash& TransportCatalogue::GetStopHash() {
+		return stop_hash_;
+	}
+
+	PerfectHash& TransportCatalogue::GetBusHash() {
+		return bus_hash_;
+	}
+
+	std::vector<DistanceTable::Record>& TransportCatalogue::GetDistances() {
+		return distances_;
+	}
+
+	std::vector<BusStat>& TransportCatalogue::GetBusStats() {
+		return bus_stats_;
 	}
 
-	std::unordered_map<std::string_view, Bus*>& TransportCatalogue::GetPointerBus() {
-		return pointer_bus_;
+	spatial::GridIndex& TransportCatalogue::GetSpatialIndex() {
+		return spatial_index_;
 	}
 
-	std::unordered_map<std::pair<std::string, std::string>, double, HashPair>& TransportCatalogue::GetDistances() {
-		return distance_;
+	std::vector<StopId>& TransportCatalogue::GetStopsByName() {
+		return stops_by_name_;
 	}
 
-	std::unordered_map<std::string, std::set<std::string_view>>& TransportCatalogue::GetListBusesForStop() {
-		return list_buses_for_stop_;
+	std::vector<BusId>& TransportCatalogue::GetBusesByName() {
+		return buses_by_name_;
 	}
 }
\ No newline at end of file
@@ -1,56 +1,237 @@
 #pragma once
 
+#include "geo.h"
+#include "spatial_index.h"
+#include "perfect_hash.h"
+
 #include <string>
 #include <unordered_map>
 #include <vector>
-#include <set>
 #include <deque>
-#include <functional>
+#include <span>
 #include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
 
 namespace catalogue {
+	using StopId = uint32_t;
+	using BusId = uint32_t;
+
+	// Названия и маршруты ссылаются на хранилище справочника
 	struct Stop {
-		std::string name_stop;
+		std::string_view name_stop;
 		double lat;
 		double lng;
+		StopId id = 0;
+	};
+
+	// Полный маршрут автобуса. Обратный путь некольцевого маршрута не хранится,
+	// а вычисляется при обращении по индексу
+	class RouteView {
+	public:
+		class Iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = StopId;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const StopId*;
+			using reference = StopId;
+
+			Iterator() = default;
+			Iterator(const RouteView* view, size_t index) :view_(view), index_(index) {}
+
+			StopId operator*()const {
+				return (*view_)[index_];
+			}
+
+			Iterator& operator++() {
+				++index_;
+				return *this;
+			}
+
+			Iterator operator++(int) {
+				Iterator result = *this;
+				++index_;
+				return result;
+			}
+
+			bool operator==(const Iterator& other)const = default;
+
+		private:
+			const RouteView* view_ = nullptr;
+			size_t index_ = 0;
+		};
+
+		RouteView(std::span<const StopId> stops, bool is_roundtrip) :stops_(stops), is_roundtrip_(is_roundtrip) {}
+
+		size_t size()const {
+			return is_roundtrip_ || stops_.empty() ? stops_.size() : stops_.size() * 2 - 1;
+		}
+
+		bool empty()const {
+			return stops_.empty();
+		}
+
+		StopId operator[](size_t index)const {
+			return index < stops_.size() ? stops_[index] : stops_[stops_.size() * 2 - 2 - index];
+		}
+
+		Iterator begin()const {
+			return { this,0 };
+		}
+
+		Iterator end()const {
+			return { this,size() };
+		}
+
+	private:
+		std::span<const StopId> stops_;
+		bool is_roundtrip_;
 	};
 
 	struct Bus {
-		std::string number_bus;
+		std::string_view number_bus;
 		bool is_roundtrip = false;
-		std::vector<std::string>route = {};
-	};
+		// Для некольцевого маршрута только путь в одну сторону
+		std::span<const StopId>route = {};
+		BusId id = 0;
 
-	struct HashPair {
-		size_t operator()(const std::pair<std::string, std::string>& val)const {
-			return std::hash<std::string>{}(val.first) * 1000000007 + std::hash<std::string>{}(val.second) * 11;
+		RouteView GetFullRoute()const {
+			return { route,is_roundtrip };
 		}
 	};
 
+	// Описания остановок и автобусов для пакетной загрузки, ссылаются на строки вызывающей стороны
+	struct StopDescription {
+		std::string_view name;
+		geo::Coordinates coords;
+		std::vector<std::pair<std::string_view, double>>distances;
+	};
+
+	struct BusDescription {
+		std::string_view name;
+		std::vector<std::string_view>stops;
+		bool is_roundtrip = false;
+	};
+
+	// Статистика маршрута, вычисляется один раз при создании базы
+	struct BusStat {
+		double curvature = 0;
+		int route_length = 0;
+		int stop_count = 0;
+		int unique_stop_count = 0;
+	};
+
+	// Неизменяемая таблица дорожных расстояний в формате CSR:
+	// для каждой остановки отсортированный список соседей с большим id.
+	// Каждое расстояние хранится один раз вместе с флагом направления,
+	// поэтому поиск симметричного расстояния не требует второго прохода.
+	class DistanceTable {
+	public:
+		struct Record {
+			StopId from;
+			StopId to;
+			double distance;
+		};
+
+		void Build(size_t stop_count, const std::vector<Record>& records);
+		double Get(StopId from, StopId to)const;
+
+	private:
+		struct Entry {
+			// (id соседа << 1) | флаг обратного направления
+			uint32_t key;
+			double distance;
+		};
+
+		std::vector<uint32_t>offsets_;
+		std::vector<Entry>entries_;
+	};
+
 	class TransportCatalogue {
 	public:
-		void ParseBus(std::string& str);
-		void AddStop(std::string& str, double lat, double lng);
-		void AddBusRing(std::string& str, int idx);
-		void AddBusStraight(std::string& str, int idx);
-		Bus* FindBus(const std::string& number)const;
+		void AddStop(std::string_view name, geo::Coordinates coords, std::span<const std::pair<std::string_view, double>> distances);
+		void AddBus(std::string_view number, std::span<const std::string_view> stops, bool is_roundtrip);
+		// Двухфазная параллельная загрузка: сначала регистрируются все остановки и автобусы,
+		// затем маршруты и расстояния переводятся в id. Результат не зависит от числа потоков
+		// (0 - по числу ядер). Остановки маршрутов должны быть описаны в stops,
+		// расстояния до неописанных остановок отбрасываются. Из повторных описаний остановки
+		// или автобуса действует последнее.
+		void AddStopsAndBuses(std::span<const StopDescription> stops, std::span<const BusDescription> buses, size_t thread_count = 0);
+		// Восстановление из базы: id назначаются по порядку, индекс названий не обновляется
+		void RestoreStop(std::string_view name, geo::Coordinates coords);
+		void RestoreBus(std::string_view number, bool is_roundtrip, std::span<const StopId> route);
+		// Упаковывает все названия в одну строку, а маршруты в один массив и освобождает
+		// промежуточное хранилище. После этого добавлять остановки и автобусы нельзя
+		void Freeze();
+		const Bus* FindBus(std::string_view number)const;
 		std::pair<double, double> CompDistance(const Bus* it);
-		std::set<std::string_view>* FindStop(const std::string& name);
-		double GetDistanceBetweenStops(const std::string& from, const std::string& to)const;
-		void SetDistanceBetweenStops(std::string& str, std::string& name, int idx, int right_idx);
-		std::deque<Bus>& GetBuses();
-		std::deque<Stop>& GetStops();
-		std::unordered_map<std::string_view, Stop*>& GetPointerStop();
-		std::unordered_map<std::string_view, Bus*>& GetPointerBus();
-		std::unordered_map<std::pair<std::string, std::string>, double, HashPair>& GetDistances();
-		std::unordered_map<std::string, std::set<std::string_view>>& GetListBusesForStop();
+		const Stop* FindStop(std::string_view name)const;
+		// Автобусы, проходящие через остановку, упорядоченные по названию
+		std::span<const BusId> GetBusesForStop(StopId id)const;
+		// Автобусы, соединяющие две остановки без пересадки, упорядоченные по названию
+		std::vector<BusId> GetDirectBuses(StopId from, StopId to)const;
+		// Ближайшие к точке остановки (count = 0 - без ограничения количества)
+		std::vector<spatial::Neighbour> FindNearestStops(geo::Coordinates center, size_t count, double radius)const;
+		void BuildSpatialIndex();
+		// Не более count остановок и автобусов, названия которых начинаются с prefix, в алфавитном порядке
+		std::span<const StopId> SuggestStops(std::string_view prefix, size_t count)const;
+		std::span<const BusId> SuggestBuses(std::string_view prefix, size_t count)const;
+		// Строит алфавитный порядок и совершенные хеш-функции названий.
+		// После этого справочник не изменяется, а хеш-таблицы названий освобождаются
+		void BuildNameIndex();
+		double GetDistanceBetweenStops(StopId from, StopId to)const;
+		void BuildIndex();
+		void ComputeBusStats();
+		const BusStat& GetBusStat(BusId id)const;
+		void SetDistanceBetweenStops(std::string_view from, std::string_view to, double distance);
+		std::vector<Bus>& GetBuses();
+		const std::vector<Bus>& GetBuses()const;
+		std::vector<Stop>& GetStops();
+		const std::vector<Stop>& GetStops()const;
+		std::vector<DistanceTable::Record>& GetDistances();
+		std::vector<BusStat>& GetBusStats();
+		spatial::GridIndex& GetSpatialIndex();
+		std::vector<StopId>& GetStopsByName();
+		std::vector<BusId>& GetBusesByName();
+		PerfectHash& GetStopHash();
+		PerfectHash& GetBusHash();
 
 	private:
-		std::unordered_map<std::string_view, Stop*>pointer_stop_;
-		std::unordered_map<std::string_view, Bus*>pointer_bus_;
-		std::unordered_map<std::string, std::set<std::string_view>>list_buses_for_stop_;
-		std::unordered_map<std::pair<std::string, std::string>, double, HashPair>distance_;
-		std::deque<Bus>buses_;
-		std::deque<Stop>stops_;
+		// Id остановки по названию, неизвестная остановка регистрируется без координат
+		StopId GetStopId(std::string_view name);
+		StopId RegisterStop(std::string name);
+		BusId RegisterBus(std::string number, bool is_roundtrip);
+
+		// Индексы названий на время загрузки, затем их заменяют совершенные хеш-функции
+		std::unordered_map<std::string_view, StopId>pointer_stop_;
+		std::unordered_map<std::string_view, BusId>pointer_bus_;
+		PerfectHash stop_hash_;
+		PerfectHash bus_hash_;
+		std::vector<DistanceTable::Record>distances_;
+		std::vector<Bus>buses_;
+		std::vector<Stop>stops_;
+		// Промежуточное хранилище названий и маршрутов (маршрут с индексом id автобуса)
+		std::deque<std::string>name_storage_;
+		std::deque<std::vector<StopId>>route_storage_;
+		// Упакованное хранилище после Freeze
+		bool frozen_ = false;
+		std::vector<char>names_;
+		std::vector<StopId>routes_;
+		DistanceTable distance_table_;
+		std::vector<BusStat>bus_stats_;
+		geo::TrigCoordinates stop_coords_;
+		spatial::GridIndex spatial_index_;
+		// Индекс остановка -> автобусы в формате CSR
+		std::vector<uint32_t>stop_buses_offsets_;
+		std::vector<BusId>stop_buses_;
+		// Id остановок и автобусов, упорядоченные по названию
+		std::vector<StopId>stops_by_name_;
+		std::vector<BusId>buses_by_name_;
+		// Битовые множества автобусов для каждой остановки.
+		// Номер бита - позиция автобуса в buses_by_name_
+		size_t bus_words_ = 0;
+		std::vector<uint64_t>stop_bus_bits_;
 	};
 }
\ No newline at end of file
@@ -17,9 +17,8 @@ namespace router {
 	}
 
 	size_t TransportRouter::GetIdStops(std::string_view stop)const {
-		if (id_stops_.count(stop))
-			return id_stops_.at(stop);
-		return id_stops_.size();
+		const auto it = id_stops_.find(stop);
+		return it == id_stops_.end() ? id_stops_.size() : it->second;
 	}
 
 	double TransportRouter::GetBusWaitTime()const {